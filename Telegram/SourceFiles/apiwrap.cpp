@@ -96,6 +96,7 @@ constexpr auto kTopPromotionMinDelay = TimeId(10);
 constexpr auto kSmallDelayMs = 5;
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
 constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
+constexpr auto kFileLoaderMaxThreads = 8;
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(6 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
@@ -152,7 +153,9 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	std::clamp(QThread::idealThreadCount(), 1, kFileLoaderMaxThreads)))
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifyTimer([=] { sendNotifySettingsUpdates(); })
 , _statsSessionKillTimer([=] { checkStatsSessions(); })
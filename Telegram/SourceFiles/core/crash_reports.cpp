@@ -250,6 +250,7 @@ void SignalHandler(int signum, siginfo_t *info, void *ucontext) {
 
 	if (ReportingThreadId.compare_exchange_strong(expected, thread)) {
 		WriteReportInfo(signum, name);
+		Logs::writePendingAfterCrash();
 		ReportingThreadId = nullptr;
 	}
 
@@ -766,7 +766,9 @@ void ForumTopic::applyTitle(const QString &title) {
 	_title = title;
 	invalidateTitleWithIcon();
 	_defaultIcon = QImage();
+	const auto oldLetters = _titleFirstLetters;
 	indexTitleParts();
+	_list->indexed()->entryNameChanged(FilterId(), this, oldLetters);
 	updateChatListEntry();
 	session().changes().topicUpdated(this, UpdateFlag::Title);
 }
@@ -112,7 +112,7 @@ void GroupCall::setPeer(not_null<PeerData*> peer) {
 
 auto GroupCall::participants() const
 -> const std::vector<Participant> & {
-	return _participants;
+	return _participants.list();
 }
 
 void GroupCall::requestParticipants() {
@@ -243,8 +243,7 @@ const GroupCallParticipant *GroupCall::participantByPeer(
 
 GroupCallParticipant *GroupCall::findParticipant(
 		not_null<PeerData*> peer) {
-	const auto i = ranges::find(_participants, peer, &Participant::peer);
-	return (i != end(_participants)) ? &*i : nullptr;
+	return _participants.find(peer);
 }
 
 const GroupCallParticipant *GroupCall::participantByEndpoint(
@@ -252,7 +251,7 @@ const GroupCallParticipant *GroupCall::participantByEndpoint(
 	if (endpoint.empty()) {
 		return nullptr;
 	}
-	for (const auto &participant : _participants) {
+	for (const auto &participant : _participants.list()) {
 		if (GetCameraEndpoint(participant.videoParams) == endpoint
 			|| GetScreenEndpoint(participant.videoParams) == endpoint) {
 			return &participant;
@@ -567,12 +566,9 @@ void GroupCall::applyParticipantsSlice(
 			const auto participantPeerId = peerFromMTP(data.vpeer());
 			const auto participantPeer = _peer->owner().peer(
 				participantPeerId);
-			const auto i = ranges::find(
-				_participants,
-				participantPeer,
-				&Participant::peer);
+			const auto i = _participants.find(participantPeer);
 			if (data.is_left()) {
-				if (i != end(_participants)) {
+				if (i) {
 					auto update = ParticipantUpdate{
 						.was = *i,
 					};
@@ -580,7 +576,7 @@ void GroupCall::applyParticipantsSlice(
 					_participantPeerByAudioSsrc.erase(
 						GetAdditionalAudioSsrc(i->videoParams));
 					_speakingByActiveFinishes.remove(participantPeer);
-					_participants.erase(i);
+					_participants.remove(participantPeer);
 					if (sliceSource != ApplySliceSource::FullReloaded) {
 						_participantUpdates.fire(std::move(update));
 					}
@@ -593,7 +589,7 @@ void GroupCall::applyParticipantsSlice(
 			if (const auto about = data.vabout()) {
 				participantPeer->setAbout(qs(*about));
 			}
-			const auto was = (i != end(_participants))
+			const auto was = i
 				? std::make_optional(*i)
 				: std::nullopt;
 			const auto canSelfUnmute = !data.is_muted()
@@ -618,7 +614,7 @@ void GroupCall::applyParticipantsSlice(
 				= data.vraise_hand_rating().value_or_empty();
 			const auto localUpdate = (sliceSource
 				== ApplySliceSource::UpdateConstructed);
-			const auto existingVideoParams = (i != end(_participants))
+			const auto existingVideoParams = i
 				? i->videoParams
 				: nullptr;
 			auto videoParams = localUpdate
@@ -650,7 +646,7 @@ void GroupCall::applyParticipantsSlice(
 				.videoJoined = videoJoined,
 				.applyVolumeFromMin = applyVolumeFromMin,
 			};
-			if (i == end(_participants)) {
+			if (!i) {
 				if (value.ssrc) {
 					_participantPeerByAudioSsrc.emplace(
 						value.ssrc,
@@ -662,7 +658,7 @@ void GroupCall::applyParticipantsSlice(
 						additional,
 						participantPeer);
 				}
-				_participants.push_back(value);
+				_participants.add(participantPeer, value);
 				if (const auto user = participantPeer->asUser()) {
 					_peer->owner().unregisterInvitedToCallUser(_id, user);
 				}
@@ -914,10 +910,8 @@ void GroupCall::requestUnknownParticipants() {
 		}
 		for (const auto &[id, when] : participantPeerIds) {
 			if (const auto participantPeer = _peer->owner().peerLoaded(id)) {
-				const auto isParticipant = ranges::contains(
-					_participants,
-					not_null{ participantPeer },
-					&Participant::peer);
+				const auto isParticipant = _participants.contains(
+					participantPeer);
 				if (isParticipant) {
 					applyActiveUpdate(id, when, participantPeer);
 				}
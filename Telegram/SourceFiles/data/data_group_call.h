@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/timer.h"
+#include "data/data_group_call_participants.h"
 
 class PeerData;
 
@@ -216,7 +217,7 @@ private:
 	base::Timer _reloadByQueuedUpdatesTimer;
 	std::optional<MTPphone_GroupCall> _savedFull;
 
-	std::vector<Participant> _participants;
+	IndexedParticipants<not_null<PeerData*>, Participant> _participants;
 	base::flat_map<uint32, not_null<PeerData*>> _participantPeerByAudioSsrc;
 	base::flat_map<not_null<PeerData*>, crl::time> _speakingByActiveFinishes;
 	base::Timer _speakingByActiveFinishTimer;
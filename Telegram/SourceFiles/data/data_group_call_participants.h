@@ -0,0 +1,73 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/assertion.h"
+#include "base/flat_map.h"
+
+#include <vector>
+
+namespace Data {
+
+// Participants are kept in the order they were added, the call bar and
+// the members list read them like that, with their positions indexed by
+// the key, so that a participant is found without a linear scan.
+template <typename Key, typename Participant>
+class IndexedParticipants final {
+public:
+	[[nodiscard]] const std::vector<Participant> &list() const {
+		return _list;
+	}
+	[[nodiscard]] int size() const {
+		return int(_list.size());
+	}
+	[[nodiscard]] bool contains(const Key &key) const {
+		return _indices.contains(key);
+	}
+	[[nodiscard]] Participant *find(const Key &key) {
+		const auto i = _indices.find(key);
+		return (i != end(_indices)) ? &_list[i->second] : nullptr;
+	}
+
+	Participant &add(const Key &key, Participant participant) {
+		Expects(!contains(key));
+
+		_indices.emplace(key, int(_list.size()));
+		_list.push_back(std::move(participant));
+		return _list.back();
+	}
+
+	// Shifts the positions after the removed one, which is no worse
+	// than the erase from the vector itself.
+	void remove(const Key &key) {
+		const auto i = _indices.find(key);
+		if (i == end(_indices)) {
+			return;
+		}
+		const auto removed = i->second;
+		_indices.erase(i);
+		for (auto &entry : _indices) {
+			if (entry.second > removed) {
+				--entry.second;
+			}
+		}
+		_list.erase(begin(_list) + removed);
+	}
+
+	void clear() {
+		_list.clear();
+		_indices.clear();
+	}
+
+private:
+	std::vector<Participant> _list;
+	base::flat_map<Key, int> _indices;
+
+};
+
+} // namespace Data
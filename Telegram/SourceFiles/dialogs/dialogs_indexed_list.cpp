@@ -33,6 +33,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 		}
 		result.letters.emplace(ch, j->second.addToEnd(key));
 	}
+	indexPrefixes(key);
 	return result;
 }
 
@@ -49,6 +50,7 @@ Row *IndexedList::addByName(Key key) {
 		}
 		j->second.addByName(key);
 	}
+	indexPrefixes(key);
 	return result;
 }
 
@@ -119,6 +121,15 @@ void IndexedList::peerNameChanged(
 	}
 }
 
+void IndexedList::entryNameChanged(
+		FilterId filterId,
+		Key key,
+		const base::flat_set<QChar> &oldLetters) {
+	Expects(_sortMode == SortMode::Date);
+
+	adjustNames(filterId, key, oldLetters);
+}
+
 void IndexedList::adjustByName(
 		Key key,
 		const base::flat_set<QChar> &oldLetters) {
@@ -127,6 +138,8 @@ void IndexedList::adjustByName(
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
 
+	indexPrefixes(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -158,15 +171,17 @@ void IndexedList::adjustByName(
 
 void IndexedList::adjustNames(
 		FilterId filterId,
-		not_null<History*> history,
+		Key key,
 		const base::flat_set<QChar> &oldLetters) {
-	const auto key = Dialogs::Key(history);
+	const auto entry = key.entry();
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
 
+	indexPrefixes(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
-	for (const auto &ch : key.entry()->chatListFirstLetters()) {
+	for (const auto &ch : entry->chatListFirstLetters()) {
 		auto j = toRemove.find(ch);
 		if (j == toRemove.cend()) {
 			toAdd.insert(ch);
@@ -176,7 +191,7 @@ void IndexedList::adjustNames(
 	}
 	for (auto ch : toRemove) {
 		if (_sortMode == SortMode::Date) {
-			history->removeChatListEntryByLetter(filterId, ch);
+			entry->removeChatListEntryByLetter(filterId, ch);
 		}
 		if (auto it = _index.find(ch); it != _index.cend()) {
 			it->second.remove(key, mainRow);
@@ -189,7 +204,7 @@ void IndexedList::adjustNames(
 		}
 		auto row = j->second.addToEnd(key);
 		if (_sortMode == SortMode::Date) {
-			history->addChatListEntryByLetter(filterId, ch, row);
+			entry->addChatListEntryByLetter(filterId, ch, row);
 		}
 	}
 }
@@ -201,12 +216,27 @@ void IndexedList::remove(Key key, Row *replacedBy) {
 				it->second.remove(key, replacedBy);
 			}
 		}
+		unindexPrefixes(key);
 	}
 }
 
 void IndexedList::clear() {
 	_list.clear();
 	_index.clear();
+	_prefixIndex.clear();
+}
+
+void IndexedList::indexPrefixes(Key key) {
+	// Only histories and topics are re-indexed when renamed.
+	if (key.history() || key.topic()) {
+		_prefixIndex.add(key, key.entry()->chatListNameWords());
+	} else {
+		_prefixIndex.addUntracked(key);
+	}
+}
+
+void IndexedList::unindexPrefixes(Key key) {
+	_prefixIndex.remove(key);
 }
 
 std::vector<not_null<Row*>> IndexedList::filtered(
@@ -233,26 +263,29 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 	if (!minimal || minimal->empty()) {
 		return result;
 	}
-	result.reserve(minimal->size());
-	for (const auto &row : *minimal) {
-		const auto &nameWords = row->entry()->chatListNameWords();
-		const auto found = [&](const QString &word) {
-			for (const auto &name : nameWords) {
-				if (name.startsWith(word)) {
-					return true;
+	const auto allFound = [&](not_null<Row*> row) {
+		return NameWordsMatch(row->entry()->chatListNameWords(), words);
+	};
+	const auto candidates = _prefixIndex.candidates(
+		words,
+		minimal->size());
+	if (candidates) {
+		result.reserve(candidates->size());
+		for (const auto &key : *candidates) {
+			if (const auto row = minimal->getRow(key)) {
+				if (allFound(row)) {
+					result.push_back(row);
 				}
 			}
-			return false;
-		};
-		const auto allFound = [&] {
-			for (const auto &word : words) {
-				if (!found(word)) {
-					return false;
-				}
-			}
-			return true;
-		}();
-		if (allFound) {
+		}
+		ranges::sort(result, ranges::less(), [](not_null<Row*> row) {
+			return row->index();
+		});
+		return result;
+	}
+	result.reserve(minimal->size());
+	for (const auto &row : *minimal) {
+		if (allFound(row)) {
 			result.push_back(row);
 		}
 	}
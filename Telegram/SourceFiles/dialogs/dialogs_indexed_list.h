@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "dialogs/dialogs_entry.h"
 #include "dialogs/dialogs_list.h"
+#include "dialogs/dialogs_name_index.h"
 
 class History;
 
@@ -39,6 +40,12 @@ public:
 		not_null<PeerData*> peer,
 		const base::flat_set<QChar> &oldChars);
 
+	// For sortMode == SortMode::Date, topics and other non-peer entries.
+	void entryNameChanged(
+		FilterId filterId,
+		Key key,
+		const base::flat_set<QChar> &oldChars);
+
 	void remove(Key key, Row *replacedBy = nullptr);
 	void clear();
 
@@ -88,14 +95,19 @@ private:
 		const base::flat_set<QChar> &oldChars);
 	void adjustNames(
 		FilterId filterId,
-		not_null<History*> history,
+		Key key,
 		const base::flat_set<QChar> &oldChars);
 
+	void indexPrefixes(Key key);
+	void unindexPrefixes(Key key);
+
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
 
+	NamePrefixIndex<Key> _prefixIndex;
+
 };
 
 } // namespace Dialogs
@@ -0,0 +1,155 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/flat_set.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace Dialogs {
+
+// Each query word must be a prefix of some of the name words.
+[[nodiscard]] inline bool NameWordsMatch(
+		const base::flat_set<QString> &nameWords,
+		const QStringList &words) {
+	const auto found = [&](const QString &word) {
+		for (const auto &name : nameWords) {
+			if (name.startsWith(word)) {
+				return true;
+			}
+		}
+		return false;
+	};
+	for (const auto &word : words) {
+		if (!found(word)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Keys by two and three first characters of their name words, so that
+// longer queries don't scan the whole first letter list. Names of the
+// untracked keys may change without re-indexing, they're always checked.
+template <typename Key>
+class NamePrefixIndex final {
+public:
+	void add(Key key, const base::flat_set<QString> &words);
+	void addUntracked(Key key);
+	void remove(Key key);
+	void clear();
+
+	// All the keys that may match the words, if there are less than limit.
+	[[nodiscard]] std::optional<std::vector<Key>> candidates(
+		const QStringList &words,
+		int limit) const;
+
+private:
+	static constexpr auto kPrefixMin = 2;
+	static constexpr auto kPrefixMax = 3;
+
+	std::map<QString, std::set<Key>> _keysByPrefix;
+	std::map<Key, base::flat_set<QString>> _prefixesByKey;
+	base::flat_set<Key> _untracked;
+
+};
+
+template <typename Key>
+void NamePrefixIndex<Key>::add(
+		Key key,
+		const base::flat_set<QString> &words) {
+	remove(key);
+
+	auto prefixes = base::flat_set<QString>();
+	for (const auto &word : words) {
+		const auto till = std::min(int(word.size()), kPrefixMax);
+		for (auto length = kPrefixMin; length <= till; ++length) {
+			prefixes.emplace(word.left(length));
+		}
+	}
+	if (prefixes.empty()) {
+		return;
+	}
+	for (const auto &prefix : prefixes) {
+		_keysByPrefix[prefix].emplace(key);
+	}
+	_prefixesByKey.emplace(key, std::move(prefixes));
+}
+
+template <typename Key>
+void NamePrefixIndex<Key>::addUntracked(Key key) {
+	remove(key);
+	_untracked.emplace(key);
+}
+
+template <typename Key>
+void NamePrefixIndex<Key>::remove(Key key) {
+	_untracked.remove(key);
+
+	const auto i = _prefixesByKey.find(key);
+	if (i == end(_prefixesByKey)) {
+		return;
+	}
+	for (const auto &prefix : i->second) {
+		const auto j = _keysByPrefix.find(prefix);
+		if (j != end(_keysByPrefix)) {
+			j->second.erase(key);
+			if (j->second.empty()) {
+				_keysByPrefix.erase(j);
+			}
+		}
+	}
+	_prefixesByKey.erase(i);
+}
+
+template <typename Key>
+void NamePrefixIndex<Key>::clear() {
+	_keysByPrefix.clear();
+	_prefixesByKey.clear();
+	_untracked.clear();
+}
+
+template <typename Key>
+auto NamePrefixIndex<Key>::candidates(
+		const QStringList &words,
+		int limit) const
+-> std::optional<std::vector<Key>> {
+	static const auto kEmpty = std::set<Key>();
+
+	auto smallest = (const std::set<Key>*)nullptr;
+	for (const auto &word : words) {
+		if (word.size() < kPrefixMin) {
+			continue;
+		}
+		const auto i = _keysByPrefix.find(word.left(kPrefixMax));
+		const auto found = (i != end(_keysByPrefix)) ? &i->second : &kEmpty;
+		if (!smallest || smallest->size() > found->size()) {
+			smallest = found;
+		}
+	}
+	if (!smallest) {
+		return std::nullopt;
+	}
+	const auto size = int(smallest->size() + _untracked.size());
+	if (size >= limit) {
+		return std::nullopt;
+	}
+	auto result = std::vector<Key>();
+	result.reserve(size);
+	result.insert(end(result), begin(*smallest), end(*smallest));
+	result.insert(end(result), begin(_untracked), end(_untracked));
+	return result;
+}
+
+} // namespace Dialogs
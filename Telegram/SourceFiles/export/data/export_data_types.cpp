@@ -2341,6 +2341,16 @@ MessagesSlice AdjustMigrateMessageIds(MessagesSlice slice) {
 	return slice;
 }
 
+int32 FirstMessageIdToExport(const DialogInfo &info, int splitIndex) {
+	const auto last = info.lastExportedMessageId;
+	if (splitIndex >= 0) {
+		return std::max(last, 0) + 1;
+	} else if (last > 0) {
+		return 0;
+	}
+	return last ? (last - kMigratedMessagesIdShift + 1) : 1;
+}
+
 TimeId SingleMessageDate(const MTPmessages_Messages &data) {
 	return data.match([&](const MTPDmessages_messagesNotModified &data) {
 		return 0;
@@ -899,6 +899,10 @@ struct DialogInfo {
 
 	// Filled when requesting dialog messages.
 	std::vector<int> messagesCountPerSplit;
+
+	// Filled from a previous export checkpoint, messages up to this id
+	// (including migrated ones with adjusted ids) are skipped.
+	int32 lastExportedMessageId = 0;
 };
 
 struct DialogsInfo {
@@ -939,6 +943,11 @@ MessagesSlice ParseMessagesSlice(
 	const QString &mediaFolder);
 MessagesSlice AdjustMigrateMessageIds(MessagesSlice slice);
 
+// Returns 0 if nothing should be requested from that split.
+[[nodiscard]] int32 FirstMessageIdToExport(
+	const DialogInfo &info,
+	int splitIndex);
+
 bool SingleMessageBefore(
 	const MTPmessages_Messages &data,
 	TimeId date);
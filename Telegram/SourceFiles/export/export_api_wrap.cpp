@@ -23,8 +23,6 @@ namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
-//constexpr auto kFileNextRequestDelay = crl::time(20);
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
@@ -178,9 +176,14 @@ struct ApiWrap::FileProcess {
 	struct Request {
 		int64 offset = 0;
 		QByteArray bytes;
+		mtpRequestId requestId = 0;
 	};
+	[[nodiscard]] Request &request(int64 offset);
+
+	// Parts are written in order, so requests keep the received parts
+	// until all the previous ones are written.
 	std::deque<Request> requests;
-	mtpRequestId requestId = 0;
+	mtpRequestId refreshRequestId = 0;
 };
 
 struct ApiWrap::FileProgress {
@@ -227,6 +230,10 @@ struct ApiWrap::ChatProcess {
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
 	int fileIndex = 0;
+
+	// While the writer is behind, the next slice is not requested.
+	bool paused = false;
+	bool waitingResume = false;
 };
 
 
@@ -342,6 +349,12 @@ ApiWrap::FileProcess::FileProcess(const QString &path, Output::Stats *stats)
 : file(path, stats) {
 }
 
+auto ApiWrap::FileProcess::request(int64 offset) -> Request& {
+	const auto i = ranges::find(requests, offset, &Request::offset);
+	Assert(i != end(requests));
+	return *i;
+}
+
 template <typename Request>
 auto ApiWrap::mainRequest(Request &&request) {
 	Expects(_takeoutId.has_value());
@@ -372,7 +385,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 	Expects(location.dcId != 0
 		|| location.data.type() == mtpc_inputTakeoutFileLocation);
 	Expects(_takeoutId.has_value());
-	Expects(_fileProcess->requestId == 0);
+	Expects(_fileProcess->refreshRequestId == 0);
 
 	return std::move(_mtp.request(MTPInvokeWithTakeout<MTPupload_GetFile>(
 		MTP_long(*_takeoutId),
@@ -382,7 +395,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			MTP_long(offset),
 			MTP_int(kFileChunkSize))
 	)).fail([=](const MTP::Error &result) {
-		_fileProcess->requestId = 0;
+		_fileProcess->request(offset).requestId = 0;
 		if (result.type() == u"TAKEOUT_FILE_EMPTY"_q
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
@@ -397,7 +410,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			filePartUnavailable();
 		} else if (result.code() == 400
 			&& result.type().startsWith(u"FILE_REFERENCE_"_q)) {
-			filePartRefreshReference(offset);
+			filePartRefreshReference();
 		} else {
 			error(std::move(result));
 		}
@@ -1183,6 +1196,9 @@ void ApiWrap::requestMessages(
 	_chatProcess->fileProgress = std::move(progress);
 	_chatProcess->handleSlice = std::move(slice);
 	_chatProcess->done = std::move(done);
+	_chatProcess->largestIdPlusOne = Data::FirstMessageIdToExport(
+		info,
+		info.splits.front());
 
 	requestMessagesCount(0);
 }
@@ -1276,8 +1292,7 @@ void ApiWrap::skipFile(uint64 randomId) {
 	}
 	LOG(("Export Info: File skipped."));
 	Assert(!_fileProcess->requests.empty());
-	Assert(_fileProcess->requestId != 0);
-	_mtp.request(base::take(_fileProcess->requestId)).cancel();
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -1598,7 +1613,7 @@ void ApiWrap::requestMessagesSlice() {
 
 	const auto count = _chatProcess->info.messagesCountPerSplit[
 		_chatProcess->localSplitIndex];
-	if (!count) {
+	if (!count || !_chatProcess->largestIdPlusOne) {
 		loadMessagesFiles({});
 		return;
 	}
@@ -1925,11 +1940,23 @@ void ApiWrap::finishMessagesSlice() {
 			return;
 		}
 	}
+	if (_chatProcess->paused) {
+		_chatProcess->waitingResume = true;
+		return;
+	}
+	requestNextMessagesSlice();
+}
+
+void ApiWrap::requestNextMessagesSlice() {
+	Expects(_chatProcess != nullptr);
+
 	if (_chatProcess->lastSlice
 		&& (++_chatProcess->localSplitIndex
 			< _chatProcess->info.splits.size())) {
 		_chatProcess->lastSlice = false;
-		_chatProcess->largestIdPlusOne = 1;
+		_chatProcess->largestIdPlusOne = Data::FirstMessageIdToExport(
+			_chatProcess->info,
+			_chatProcess->info.splits[_chatProcess->localSplitIndex]);
 	}
 	if (!_chatProcess->lastSlice) {
 		requestMessagesSlice();
@@ -2002,6 +2029,22 @@ void ApiWrap::loadMessageEmojiDone(uint64 id, const QString &relativePath) {
 	loadNextMessageFile();
 }
 
+void ApiWrap::pauseMessages() {
+	Expects(_chatProcess != nullptr);
+
+	_chatProcess->paused = true;
+}
+
+void ApiWrap::resumeMessages() {
+	if (!_chatProcess || !_chatProcess->paused) {
+		return;
+	}
+	_chatProcess->paused = false;
+	if (base::take(_chatProcess->waitingResume)) {
+		requestNextMessagesSlice();
+	}
+}
+
 void ApiWrap::finishMessages() {
 	Expects(_chatProcess != nullptr);
 	Expects(!_chatProcess->slice.has_value());
@@ -2122,7 +2165,7 @@ void ApiWrap::loadFile(
 
 	loadFilePart();
 
-	Ensures(_fileProcess->requestId != 0);
+	Ensures(!_fileProcess->requests.empty());
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -2146,36 +2189,56 @@ auto ApiWrap::prepareFileProcess(
 }
 
 void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requestId
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
+	if (!_fileProcess || _fileProcess->refreshRequestId) {
 		return;
 	}
+	auto &requests = _fileProcess->requests;
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	_fileProcess->requestId = fileRequest(
+	// Resend the parts cancelled while refreshing the file reference.
+	for (const auto &request : requests) {
+		if (!request.requestId && request.bytes.isEmpty()) {
+			sendFilePart(request.offset);
+		}
+	}
+
+	// Without a known size we request parts one by one till the empty one.
+	const auto window = (_fileProcess->size > 0)
+		? _settings->media.partsInFlight
+		: 1;
+	while (int(requests.size()) < window
+		&& (!_fileProcess->size
+			|| _fileProcess->offset < _fileProcess->size)) {
+		const auto offset = _fileProcess->offset;
+		requests.push_back({ offset });
+		_fileProcess->offset += kFileChunkSize;
+		sendFilePart(offset);
+	}
+}
+
+void ApiWrap::sendFilePart(int64 offset) {
+	Expects(_fileProcess != nullptr);
+
+	auto &request = _fileProcess->request(offset);
+	Assert(!request.requestId);
+	request.requestId = fileRequest(
 		_fileProcess->location,
-		_fileProcess->offset
+		offset
 	).done([=](const MTPupload_File &result) {
-		_fileProcess->requestId = 0;
+		_fileProcess->request(offset).requestId = 0;
 		filePartDone(offset, result);
 	}).send();
-	_fileProcess->offset += kFileChunkSize;
+}
 
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		// Only one request at a time supported right now.
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+void ApiWrap::cancelFileRequests() {
+	Expects(_fileProcess != nullptr);
+
+	for (auto &request : _fileProcess->requests) {
+		if (request.requestId) {
+			_mtp.request(base::take(request.requestId)).cancel();
+		}
+	}
+	if (_fileProcess->refreshRequestId) {
+		_mtp.request(base::take(_fileProcess->refreshRequestId)).cancel();
 	}
 }
 
@@ -2199,15 +2262,8 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 			return;
 		}
 	} else {
-		using Request = FileProcess::Request;
 		auto &requests = _fileProcess->requests;
-		const auto i = ranges::find(
-			requests,
-			offset,
-			[](const Request &request) { return request.offset; });
-		Assert(i != end(requests));
-
-		i->bytes = data.vbytes().v;
+		_fileProcess->request(offset).bytes = data.vbytes().v;
 
 		auto &file = _fileProcess->file;
 		while (!requests.empty() && !requests.front().bytes.isEmpty()) {
@@ -2239,22 +2295,30 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 	process->done(process->relativePath);
 }
 
-void ApiWrap::filePartRefreshReference(int64 offset) {
+void ApiWrap::filePartRefreshReference() {
 	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+
+	if (_fileProcess->refreshRequestId) {
+		// The part will be requested again after the refresh.
+		return;
+	}
+
+	// All the parts in flight will fail with the same error,
+	// cancel them now and send again with the refreshed reference.
+	cancelFileRequests();
 
 	const auto &origin = _fileProcess->origin;
 	if (origin.storyId) {
-		_fileProcess->requestId = mainRequest(MTPstories_GetStoriesByID(
+		_fileProcess->refreshRequestId = mainRequest(MTPstories_GetStoriesByID(
 			MTP_inputPeerSelf(),
 			MTP_vector<MTPint>(1, MTP_int(origin.storyId))
 		)).fail([=](const MTP::Error &error) {
-			_fileProcess->requestId = 0;
+			_fileProcess->refreshRequestId = 0;
 			filePartUnavailable();
 			return true;
 		}).done([=](const MTPstories_Stories &result) {
-			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			_fileProcess->refreshRequestId = 0;
+			filePartExtractReference(result);
 		}).send();
 		return;
 	} else if (!origin.messageId) {
@@ -2271,21 +2335,21 @@ void ApiWrap::filePartRefreshReference(int64 offset) {
 				origin.peer.c_inputPeerChannelFromMessage().vpeer(),
 				origin.peer.c_inputPeerChannelFromMessage().vmsg_id(),
 				origin.peer.c_inputPeerChannelFromMessage().vchannel_id());
-		_fileProcess->requestId = mainRequest(MTPchannels_GetMessages(
+		_fileProcess->refreshRequestId = mainRequest(MTPchannels_GetMessages(
 			channel,
 			MTP_vector<MTPInputMessage>(
 				1,
 				MTP_inputMessageID(MTP_int(origin.messageId)))
 		)).fail([=](const MTP::Error &error) {
-			_fileProcess->requestId = 0;
+			_fileProcess->refreshRequestId = 0;
 			filePartUnavailable();
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
-			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			_fileProcess->refreshRequestId = 0;
+			filePartExtractReference(result);
 		}).send();
 	} else {
-		_fileProcess->requestId = splitRequest(
+		_fileProcess->refreshRequestId = splitRequest(
 			origin.split,
 			MTPmessages_GetMessages(
 				MTP_vector<MTPInputMessage>(
@@ -2293,21 +2357,20 @@ void ApiWrap::filePartRefreshReference(int64 offset) {
 					MTP_inputMessageID(MTP_int(origin.messageId)))
 			)
 		).fail([=](const MTP::Error &error) {
-			_fileProcess->requestId = 0;
+			_fileProcess->refreshRequestId = 0;
 			filePartUnavailable();
 			return true;
 		}).done([=](const MTPmessages_Messages &result) {
-			_fileProcess->requestId = 0;
-			filePartExtractReference(offset, result);
+			_fileProcess->refreshRequestId = 0;
+			filePartExtractReference(result);
 		}).send();
 	}
 }
 
 void ApiWrap::filePartExtractReference(
-		int64 offset,
 		const MTPmessages_Messages &result) {
 	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+	Expects(_fileProcess->refreshRequestId == 0);
 
 	result.match([&](const MTPDmessages_messagesNotModified &data) {
 		error("Unexpected messagesNotModified received.");
@@ -2331,13 +2394,7 @@ void ApiWrap::filePartExtractReference(
 					_fileProcess->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
-					_fileProcess->requestId = fileRequest(
-						_fileProcess->location,
-						offset
-					).done([=](const MTPupload_File &result) {
-						_fileProcess->requestId = 0;
-						filePartDone(offset, result);
-					}).send();
+					loadFilePart();
 					return;
 				}
 			}
@@ -2347,10 +2404,9 @@ void ApiWrap::filePartExtractReference(
 }
 
 void ApiWrap::filePartExtractReference(
-		int64 offset,
 		const MTPstories_Stories &result) {
 	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+	Expects(_fileProcess->refreshRequestId == 0);
 
 	const auto stories = Data::ParseStoriesSlice(
 		result.data().vstories(),
@@ -2364,13 +2420,7 @@ void ApiWrap::filePartExtractReference(
 				_fileProcess->location,
 				story.thumb().file.location);
 			if (refresh1 || refresh2) {
-				_fileProcess->requestId = fileRequest(
-					_fileProcess->location,
-					offset
-				).done([=](const MTPupload_File &result) {
-					_fileProcess->requestId = 0;
-					filePartDone(offset, result);
-				}).send();
+				loadFilePart();
 				return;
 			}
 		}
@@ -2384,6 +2434,7 @@ void ApiWrap::filePartUnavailable() {
 
 	LOG(("Export Error: File unavailable."));
 
+	cancelFileRequests();
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -95,6 +95,10 @@ public:
 		Fn<bool(Data::MessagesSlice&&)> slice,
 		FnMut<void()> done);
 
+	// While paused the next messages slice is not requested.
+	void pauseMessages();
+	void resumeMessages();
+
 	void finishExport(FnMut<void()> done);
 	void skipFile(uint64 randomId);
 	void cancelExportFast();
@@ -192,6 +196,7 @@ private:
 	bool loadMessageEmojiProgress(FileProgress progress);
 	void loadMessageEmojiDone(uint64 id, const QString &relativePath);
 	void finishMessagesSlice();
+	void requestNextMessagesSlice();
 	void finishMessages();
 
 	[[nodiscard]] Data::Message *currentFileMessage() const;
@@ -216,15 +221,13 @@ private:
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
 	void loadFilePart();
+	void sendFilePart(int64 offset);
+	void cancelFileRequests();
 	void filePartDone(int64 offset, const MTPupload_File &result);
 	void filePartUnavailable();
-	void filePartRefreshReference(int64 offset);
-	void filePartExtractReference(
-		int64 offset,
-		const MTPmessages_Messages &result);
-	void filePartExtractReference(
-		int64 offset,
-		const MTPstories_Stories &result);
+	void filePartRefreshReference();
+	void filePartExtractReference(const MTPmessages_Messages &result);
+	void filePartExtractReference(const MTPstories_Stories &result);
 
 	template <typename Request>
 	class RequestBuilder;
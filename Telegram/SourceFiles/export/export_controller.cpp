@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_settings.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_abstract.h"
+#include "export/output/export_output_checkpoint.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_stats.h"
 #include "mtproto/mtp_instance.h"
@@ -18,6 +19,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Export {
 namespace {
 
+// Slices written on the writer queue while the next ones are requested.
+constexpr auto kMaxSlicesInWriting = 2;
+
 const auto kNullStateCallback = [](ProcessingState&) {};
 
 Settings NormalizeSettings(const Settings &settings) {
@@ -26,6 +30,8 @@ Settings NormalizeSettings(const Settings &settings) {
 	}
 	auto result = base::duplicate(settings);
 	result.types = result.fullChats = Settings::Type::AnyChatsMask;
+	result.incremental = false;
+	result.previousCheckpoint = QString();
 	return result;
 }
 
@@ -37,8 +43,10 @@ public:
 		crl::weak_on_queue<ControllerObject> weak,
 		QPointer<MTP::Instance> mtproto,
 		const MTPInputPeer &peer);
+	~ControllerObject();
 
 	rpl::producer<State> state() const;
+	rpl::producer<QString> checkpointWritten() const;
 
 	// Password step.
 	//void submitPassword(const QString &password);
@@ -81,6 +89,14 @@ private:
 	void exportOtherData();
 	void exportDialogs();
 	void exportNextDialog();
+	void writeDialogSlice(PeerId peerId, Data::MessagesSlice &&slice);
+	void dialogSliceWritten(
+		PeerId peerId,
+		int32 lastMessageId,
+		int count,
+		const Output::Result &result);
+	void afterSlicesWritten(FnMut<void()> callback);
+	void writeCheckpoint();
 
 	template <typename Callback = const decltype(kNullStateCallback) &>
 	ProcessingState prepareState(
@@ -103,6 +119,7 @@ private:
 
 	int substepsInStep(Step step) const;
 
+	crl::weak_on_queue<ControllerObject> _weak;
 	ApiWrap _api;
 	Settings _settings;
 	Environment _environment;
@@ -124,13 +141,23 @@ private:
 	rpl::event_stream<State> _stateChanges;
 
 	Output::Stats _stats;
+	Output::Checkpoint _checkpoint;
+	QString _checkpointPath;
+	rpl::event_stream<QString> _checkpointWritten;
 
 	std::vector<int> _substepsInStep;
 	int _substepsTotal = 0;
 	mutable int _substepsPassed = 0;
 	mutable Step _lastProcessingStep = Step::Initializing;
 
+	// Dialog slices are serialized on _writerQueue, so that the next slice
+	// is requested and its files are downloaded in the meantime. The writer
+	// is used here only when there are no slices in writing.
 	std::unique_ptr<Output::AbstractWriter> _writer;
+	crl::queue _writerQueue;
+	int _slicesInWriting = 0;
+	FnMut<void()> _afterSlicesWritten;
+
 	std::vector<Step> _steps;
 	int _stepIndex = -1;
 
@@ -142,7 +169,8 @@ ControllerObject::ControllerObject(
 	crl::weak_on_queue<ControllerObject> weak,
 	QPointer<MTP::Instance> mtproto,
 	const MTPInputPeer &peer)
-: _api(mtproto, weak.runner())
+: _weak(weak)
+, _api(mtproto, weak.runner())
 , _state(PasswordCheckState{}) {
 	_api.errors(
 	) | rpl::start_with_next([=](const MTP::Error &error) {
@@ -162,6 +190,11 @@ ControllerObject::ControllerObject(
 	setState(std::move(state));
 }
 
+ControllerObject::~ControllerObject() {
+	// Wait for the slice in writing, it uses _writer and _stats.
+	_writerQueue.sync([] {});
+}
+
 rpl::producer<State> ControllerObject::state() const {
 	return rpl::single(
 		_state
@@ -173,6 +206,10 @@ rpl::producer<State> ControllerObject::state() const {
 	});
 }
 
+rpl::producer<QString> ControllerObject::checkpointWritten() const {
+	return _checkpointWritten.events();
+}
+
 bool ControllerObject::stopped() const {
 	return v::is<CancelledState>(_state)
 		|| v::is<ApiErrorState>(_state)
@@ -253,6 +290,18 @@ void ControllerObject::startExport(
 	_settings = NormalizeSettings(settings);
 	_environment = environment;
 
+	if (_settings.incremental && !_settings.previousCheckpoint.isEmpty()) {
+		const auto previous = Output::ReadCheckpoint(
+			_settings.previousCheckpoint);
+		if (previous) {
+			_checkpoint = *previous;
+		} else {
+			LOG(("Export Warning: Could not read checkpoint '%1', "
+				"exporting everything."
+				).arg(_settings.previousCheckpoint));
+		}
+	}
+
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
 	fillExportSteps();
@@ -497,6 +546,11 @@ void ControllerObject::exportNextDialog() {
 	const auto index = ++_dialogIndex;
 	const auto info = _dialogsInfo.item(index);
 	if (info) {
+		const auto peerId = info->peerId;
+		const auto i = _checkpoint.lastMessageIds.find(peerId);
+		if (i != end(_checkpoint.lastMessageIds)) {
+			info->lastExportedMessageId = i->second;
+		}
 		_api.requestMessages(*info, [=](const Data::DialogInfo &info) {
 			if (ioCatchError(_writer->writeDialogStart(info))) {
 				return false;
@@ -511,26 +565,100 @@ void ControllerObject::exportNextDialog() {
 			setState(stateDialogs(progress));
 			return true;
 		}, [=](Data::MessagesSlice &&result) {
-			if (ioCatchError(_writer->writeDialogSlice(result))) {
-				return false;
-			}
-			_messagesWritten += result.list.size();
-			setState(stateDialogs(DownloadProgress()));
-			return true;
+			writeDialogSlice(peerId, std::move(result));
+			return !stopped();
 		}, [=] {
-			if (ioCatchError(_writer->writeDialogEnd())) {
-				return;
-			}
-			exportNextDialog();
+			afterSlicesWritten([=] {
+				if (ioCatchError(_writer->writeDialogEnd())) {
+					return;
+				}
+				exportNextDialog();
+			});
 		});
 		return;
 	}
 	if (ioCatchError(_writer->writeDialogsEnd())) {
 		return;
 	}
+	writeCheckpoint();
 	exportNext();
 }
 
+void ControllerObject::writeDialogSlice(
+		PeerId peerId,
+		Data::MessagesSlice &&slice) {
+	if (++_slicesInWriting == kMaxSlicesInWriting) {
+		_api.pauseMessages();
+	}
+	const auto lastMessageId = slice.list.empty()
+		? 0
+		: slice.list.back().id;
+	const auto count = int(slice.list.size());
+	_writerQueue.async([
+		=,
+		weak = _weak,
+		writer = _writer.get(),
+		slice = std::move(slice)
+	] {
+		const auto result = writer->writeDialogSlice(slice);
+		weak.with([=](ControllerObject &that) {
+			that.dialogSliceWritten(peerId, lastMessageId, count, result);
+		});
+	});
+}
+
+void ControllerObject::dialogSliceWritten(
+		PeerId peerId,
+		int32 lastMessageId,
+		int count,
+		const Output::Result &result) {
+	if (ioCatchError(result)) {
+		return;
+	}
+	_messagesWritten += count;
+	if (lastMessageId) {
+		_checkpoint.lastMessageIds[peerId] = lastMessageId;
+		writeCheckpoint();
+	}
+	setState(stateDialogs(DownloadProgress()));
+
+	if (_slicesInWriting-- == kMaxSlicesInWriting) {
+		_api.resumeMessages();
+	}
+	if (!_slicesInWriting && _afterSlicesWritten) {
+		base::take(_afterSlicesWritten)();
+	}
+}
+
+void ControllerObject::afterSlicesWritten(FnMut<void()> callback) {
+	Expects(!_afterSlicesWritten);
+
+	if (_slicesInWriting) {
+		_afterSlicesWritten = std::move(callback);
+	} else {
+		callback();
+	}
+}
+
+void ControllerObject::writeCheckpoint() {
+	if (!_settings.incremental) {
+		return;
+	}
+	// The export itself is fine without the checkpoint, it only won't
+	// be possible to continue after it later.
+	const auto path = Output::CheckpointPath(_settings.path);
+	const auto result = Output::WriteCheckpoint(path, _checkpoint);
+	if (!result) {
+		LOG(("Export Warning: Could not write checkpoint to '%1'."
+			).arg(path));
+	} else if (_checkpointPath != path) {
+		// The next export continues after this one, even if this one
+		// is interrupted or its folder is moved later.
+		_checkpointPath = path;
+		_checkpointWritten.fire_copy(path);
+	}
+}
+
 template <typename Callback>
 ProcessingState ControllerObject::prepareState(
 		Step step,
@@ -674,6 +802,12 @@ rpl::producer<State> Controller::state() const {
 	});
 }
 
+rpl::producer<QString> Controller::checkpointWritten() const {
+	return _wrapped.producer_on_main([=](const Implementation &unwrapped) {
+		return unwrapped.checkpointWritten();
+	});
+}
+
 //void Controller::submitPassword(const QString &password) {
 //	_wrapped.with([=](Implementation &unwrapped) {
 //		unwrapped.submitPassword(password);
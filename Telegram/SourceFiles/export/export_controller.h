@@ -116,6 +116,7 @@ public:
 		const MTPInputPeer &peer);
 
 	rpl::producer<State> state() const;
+	rpl::producer<QString> checkpointWritten() const;
 
 	// Password step.
 	//void submitPassword(const QString &password);
@@ -21,6 +21,8 @@ bool MediaSettings::validate() const {
 		return false;
 	} else if (sizeLimit < 0 || sizeLimit > kMaxFileSize) {
 		return false;
+	} else if (partsInFlight < 1 || partsInFlight > kMaxPartsInFlight) {
+		return false;
 	}
 	return true;
 }
@@ -35,6 +35,9 @@ struct MediaSettings {
 
 	Types types = DefaultTypes();
 	int64 sizeLimit = 8 * 1024 * 1024;
+	int partsInFlight = 4; // Parallel part requests for a single file.
+
+	static constexpr auto kMaxPartsInFlight = 16;
 
 	static inline Types DefaultTypes() {
 		return Type::Photo;
@@ -88,6 +91,11 @@ struct Settings {
 
 	TimeId availableAt = 0;
 
+	// Write a checkpoint to the export folder while exporting and, if
+	// previousCheckpoint is set, export only messages newer than in it.
+	bool incremental = false;
+	QString previousCheckpoint;
+
 	bool onlySinglePeer() const {
 		return singlePeer.type() != mtpc_inputPeerEmpty;
 	}
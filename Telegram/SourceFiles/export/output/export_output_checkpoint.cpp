@@ -0,0 +1,83 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/output/export_output_checkpoint.h"
+
+#include "export/output/export_output_result.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+namespace Export {
+namespace Output {
+namespace {
+
+constexpr auto kCheckpointVersion = 1;
+constexpr auto kCheckpointFileName = "export_checkpoint.json";
+
+} // namespace
+
+QString CheckpointPath(const QString &folder) {
+	return folder + kCheckpointFileName;
+}
+
+std::optional<Checkpoint> ReadCheckpoint(const QString &path) {
+	auto file = QFile(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return std::nullopt;
+	}
+	auto error = QJsonParseError{ 0, QJsonParseError::NoError };
+	const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+	if (error.error != QJsonParseError::NoError || !document.isObject()) {
+		return std::nullopt;
+	}
+	const auto object = document.object();
+	if (object.value("version").toInt() != kCheckpointVersion) {
+		return std::nullopt;
+	}
+	auto result = Checkpoint();
+	for (const auto &value : object.value("dialogs").toArray()) {
+		const auto dialog = value.toObject();
+		const auto peerId = PeerId(dialog.value("peer_id").toString(
+		).toULongLong());
+		const auto messageId = dialog.value("last_message_id").toInt();
+		if (peerId && messageId) {
+			result.lastMessageIds.emplace(peerId, messageId);
+		}
+	}
+	return result;
+}
+
+Result WriteCheckpoint(const QString &path, const Checkpoint &checkpoint) {
+	auto dialogs = QJsonArray();
+	for (const auto &[peerId, messageId] : checkpoint.lastMessageIds) {
+		dialogs.append(QJsonObject{
+			{ "peer_id", QString::number(peerId.value) },
+			{ "last_message_id", messageId },
+		});
+	}
+	const auto data = QJsonDocument(QJsonObject{
+		{ "version", kCheckpointVersion },
+		{ "dialogs", dialogs },
+	}).toJson(QJsonDocument::Compact);
+
+	// Replace the whole file at once, a cancelled export should never
+	// leave a partially written checkpoint behind.
+	auto file = QSaveFile(path);
+	if (!file.open(QIODevice::WriteOnly)
+		|| file.write(data) != data.size()
+		|| !file.commit()) {
+		return Result(Result::Type::Error, path);
+	}
+	return Result::Success();
+}
+
+} // namespace Output
+} // namespace Export
@@ -0,0 +1,32 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/flat_map.h"
+
+namespace Export {
+namespace Output {
+
+struct Result;
+
+// Progress of the dialogs export, rewritten after each written slice,
+// so that a later export can continue after the last written message.
+struct Checkpoint {
+	// Message ids are the same as in the output, so for supergroups
+	// migrated from groups the old group messages have negative ids.
+	base::flat_map<PeerId, int32> lastMessageIds;
+};
+
+[[nodiscard]] QString CheckpointPath(const QString &folder);
+[[nodiscard]] std::optional<Checkpoint> ReadCheckpoint(const QString &path);
+[[nodiscard]] Result WriteCheckpoint(
+	const QString &path,
+	const Checkpoint &checkpoint);
+
+} // namespace Output
+} // namespace Export
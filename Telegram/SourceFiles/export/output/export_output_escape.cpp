@@ -0,0 +1,124 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/output/export_output_escape.h"
+
+namespace Export {
+namespace Output {
+
+void AppendJsonString(QByteArray &to, const QByteArray &value) {
+	const auto begin = value.data();
+	const auto end = begin + value.size();
+
+	// Characters that don't need escaping are copied in whole runs.
+	auto plain = begin;
+	const auto replace = [&](const char *p, const char *with, int size) {
+		to.append(plain, p - plain).append(with, size);
+		plain = p + 1;
+	};
+	to.append('"');
+	for (auto p = begin; p != end; ++p) {
+		const auto ch = *p;
+		if (ch == '\n') {
+			replace(p, "\\n", 2);
+		} else if (ch == '\r') {
+			replace(p, "\\r", 2);
+		} else if (ch == '\t') {
+			replace(p, "\\t", 2);
+		} else if (ch == '"') {
+			replace(p, "\\\"", 2);
+		} else if (ch == '\\') {
+			replace(p, "\\\\", 2);
+		} else if (ch >= 0 && ch < 32) {
+			const auto left = (ch & 0x0F);
+			const char code[] = {
+				'\\',
+				'x',
+				char('0' + (ch >> 4)),
+				char((left >= 10) ? ('A' + (left - 10)) : ('0' + left)),
+			};
+			replace(p, code, sizeof(code));
+		} else if (ch == char(0xE2)
+			&& (p + 2 < end)
+			&& *(p + 1) == char(0x80)) {
+			if (*(p + 2) == char(0xA8)) { // Line separator.
+				replace(p, "\\u2028", 6);
+			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
+				replace(p, "\\u2029", 6);
+			}
+		}
+	}
+	to.append(plain, end - plain).append('"');
+}
+
+QByteArray SerializeJsonString(const QByteArray &value) {
+	auto result = QByteArray();
+	result.reserve(value.size() + 2);
+	AppendJsonString(result, value);
+	return result;
+}
+
+QByteArray SerializeHtmlString(const QByteArray &value) {
+	const auto size = value.size();
+	const auto begin = value.data();
+	const auto end = begin + size;
+
+	// Characters that don't need escaping are copied in whole runs,
+	// the result is allocated only if something was actually replaced.
+	auto result = QByteArray();
+	auto plain = begin;
+	const auto replace = [&](const char *p, const char *with, int length) {
+		if (plain == begin) {
+			result.reserve(size + length + 16);
+		}
+		result.append(plain, p - plain).append(with, length);
+		plain = p + 1;
+	};
+	for (auto p = begin; p != end; ++p) {
+		const auto ch = *p;
+		if (ch == '\n') {
+			replace(p, "<br>", 4);
+		} else if (ch == '"') {
+			replace(p, "&quot;", 6);
+		} else if (ch == '&') {
+			replace(p, "&amp;", 5);
+		} else if (ch == '\'') {
+			replace(p, "&apos;", 6);
+		} else if (ch == '<') {
+			replace(p, "&lt;", 4);
+		} else if (ch == '>') {
+			replace(p, "&gt;", 4);
+		} else if (ch >= 0 && ch < 32) {
+			const auto left = (ch & 0x0F);
+			const char code[] = {
+				'&',
+				'#',
+				'x',
+				char('0' + (ch >> 4)),
+				char((left >= 10) ? ('A' + (left - 10)) : ('0' + left)),
+				';',
+			};
+			replace(p, code, sizeof(code));
+		} else if (ch == char(0xE2)
+			&& (p + 2 < end)
+			&& *(p + 1) == char(0x80)) {
+			if (*(p + 2) == char(0xA8)) { // Line separator.
+				replace(p, "<br>", 4);
+			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
+				replace(p, "<br>", 4);
+			}
+		}
+	}
+	if (plain == begin) {
+		return value;
+	}
+	result.append(plain, end - plain);
+	return result;
+}
+
+} // namespace Output
+} // namespace Export
@@ -0,0 +1,23 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QByteArray>
+
+namespace Export {
+namespace Output {
+
+// Appends the value as a quoted JSON string.
+void AppendJsonString(QByteArray &to, const QByteArray &value);
+[[nodiscard]] QByteArray SerializeJsonString(const QByteArray &value);
+
+// Escapes the value for HTML text and attribute values.
+[[nodiscard]] QByteArray SerializeHtmlString(const QByteArray &value);
+
+} // namespace Output
+} // namespace Export
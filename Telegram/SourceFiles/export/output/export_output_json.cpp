@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "export/output/export_output_json.h"
 
+#include "export/output/export_output_escape.h"
 #include "export/output/export_output_result.h"
 #include "export/data/export_data_types.h"
 #include "core/utils.h"
@@ -24,49 +25,7 @@ namespace {
 using Context = details::JsonContext;
 
 QByteArray SerializeString(const QByteArray &value) {
-	const auto size = value.size();
-	const auto begin = value.data();
-	const auto end = begin + size;
-
-	auto result = QByteArray();
-	result.reserve(2 + size * 4);
-	result.append('"');
-	for (auto p = begin; p != end; ++p) {
-		const auto ch = *p;
-		if (ch == '\n') {
-			result.append("\\n", 2);
-		} else if (ch == '\r') {
-			result.append("\\r", 2);
-		} else if (ch == '\t') {
-			result.append("\\t", 2);
-		} else if (ch == '"') {
-			result.append("\\\"", 2);
-		} else if (ch == '\\') {
-			result.append("\\\\", 2);
-		} else if (ch >= 0 && ch < 32) {
-			result.append("\\x", 2).append('0' + (ch >> 4));
-			const auto left = (ch & 0x0F);
-			if (left >= 10) {
-				result.append('A' + (left - 10));
-			} else {
-				result.append('0' + left);
-			}
-		} else if (ch == char(0xE2)
-			&& (p + 2 < end)
-			&& *(p + 1) == char(0x80)) {
-			if (*(p + 2) == char(0xA8)) { // Line separator.
-				result.append("\\u2028", 6);
-			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
-				result.append("\\u2029", 6);
-			} else {
-				result.append(ch);
-			}
-		} else {
-			result.append(ch);
-		}
-	}
-	result.append('"');
-	return result;
+	return SerializeJsonString(value);
 }
 
 QByteArray SerializeDate(TimeId date) {
@@ -103,8 +62,13 @@ QByteArray SerializeObject(
 	const auto guard = gsl::finally([&] { context.nesting.pop_back(); });
 	const auto next = '\n' + Indentation(context);
 
+	auto size = indent.size() + 3;
+	for (const auto &[key, value] : values) {
+		size += next.size() + key.size() + value.size() + 5;
+	}
 	auto first = true;
 	auto result = QByteArray();
+	result.reserve(size);
 	result.append('{');
 	for (const auto &[key, value] : values) {
 		if (value.isEmpty()) {
@@ -115,8 +79,9 @@ QByteArray SerializeObject(
 		} else {
 			result.append(',');
 		}
-		result.append(next).append(SerializeString(key)).append(": ", 2);
-		result.append(value);
+		result.append(next);
+		AppendJsonString(result, key);
+		result.append(": ", 2).append(value);
 	}
 	result.append('\n').append(indent).append("}");
 	return result;
@@ -128,8 +93,13 @@ QByteArray SerializeArray(
 	const auto indent = Indentation(context.nesting.size());
 	const auto next = '\n' + Indentation(context.nesting.size() + 1);
 
+	auto size = indent.size() + 3;
+	for (const auto &value : values) {
+		size += next.size() + value.size() + 1;
+	}
 	auto first = true;
 	auto result = QByteArray();
+	result.reserve(size);
 	result.append('[');
 	for (const auto &value : values) {
 		if (first) {
@@ -1523,7 +1493,7 @@ Result JsonWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
-		block.append(prepareArrayItemStart() + SerializeMessage(
+		block.append(prepareArrayItemStart()).append(SerializeMessage(
 			_context,
 			message,
 			data.peers,
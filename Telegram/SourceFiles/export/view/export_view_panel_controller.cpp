@@ -149,6 +149,12 @@ PanelController::PanelController(
 	) | rpl::start_with_next([=](State &&state) {
 		updateState(std::move(state));
 	}, _lifetime);
+
+	_process->checkpointWritten(
+	) | rpl::start_with_next([=](const QString &path) {
+		_settings->previousCheckpoint = path;
+		saveSettings();
+	}, _lifetime);
 }
 
 PanelController::~PanelController() {
@@ -285,6 +285,7 @@ void SettingsWidget::setupPathAndFormat(
 	addFormatOption(tr::lng_export_option_html(tr::now), Format::Html);
 	addFormatOption(tr::lng_export_option_json(tr::now), Format::Json);
 	addFormatOption(tr::lng_export_option_html_and_json(tr::now), Format::HtmlAndJson);
+	addIncrementalOption(container);
 }
 
 void SettingsWidget::addLocationLabel(
@@ -457,6 +458,56 @@ void SettingsWidget::addLimitsLabel(
 	});
 }
 
+void SettingsWidget::addIncrementalOption(
+		not_null<Ui::VerticalLayout*> container) {
+	const auto checkbox = container->add(
+		object_ptr<Ui::Checkbox>(
+			container,
+			tr::lng_export_option_incremental(tr::now),
+			readData().incremental,
+			st::defaultBoxCheckbox),
+		st::exportSettingPadding);
+	container->add(
+		object_ptr<Ui::FlatLabel>(
+			container,
+			tr::lng_export_option_incremental_about(tr::now),
+			st::exportAboutOptionLabel),
+		st::exportAboutOptionPadding);
+
+	auto previousLink = value() | rpl::map([](const Settings &data) {
+		return data.previousCheckpoint;
+	}) | rpl::distinct_until_changed(
+	) | rpl::map([](const QString &path) {
+		const auto text = path.isEmpty()
+			? tr::lng_export_option_previous_none(tr::now)
+			: QDir::toNativeSeparators(path);
+		return Ui::Text::Link(text, QString("internal:edit_previous"));
+	});
+	const auto previous = container->add(
+		object_ptr<Ui::SlideWrap<Ui::FlatLabel>>(
+			container,
+			object_ptr<Ui::FlatLabel>(
+				container,
+				tr::lng_export_option_previous(
+					lt_path,
+					std::move(previousLink),
+					Ui::Text::WithEntities),
+				st::exportLocationLabel),
+			st::exportLocationPadding));
+	previous->entity()->overrideLinkClickHandler([=] {
+		choosePreviousCheckpoint();
+	});
+	previous->toggle(readData().incremental, anim::type::instant);
+
+	checkbox->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		changeData([&](Settings &data) {
+			data.incremental = checked;
+		});
+		previous->toggle(checked, anim::type::normal);
+	}, checkbox->lifetime());
+}
+
 void SettingsWidget::editDateLimit(
 		TimeId current,
 		TimeId min,
@@ -667,6 +718,7 @@ void SettingsWidget::addMediaOptions(
 		tr::lng_export_option_files(tr::now),
 		MediaType::File);
 	addSizeSlider(container);
+	addPartsInFlightSlider(container);
 }
 
 void SettingsWidget::addMediaOption(
@@ -736,6 +788,47 @@ void SettingsWidget::addSizeSlider(
 	}, label->lifetime());
 }
 
+void SettingsWidget::addPartsInFlightSlider(
+		not_null<Ui::VerticalLayout*> container) {
+	using namespace rpl::mappers;
+
+	const auto slider = container->add(
+		object_ptr<Ui::MediaSlider>(container, st::exportFileSizeSlider),
+		st::exportFileSizePadding);
+	slider->resize(st::exportFileSizeSlider.seekSize);
+	slider->setPseudoDiscrete(
+		MediaSettings::kMaxPartsInFlight,
+		[](int index) { return index + 1; },
+		readData().media.partsInFlight,
+		[=](int count) {
+			changeData([&](Settings &data) {
+				data.media.partsInFlight = count;
+			});
+		});
+
+	const auto label = Ui::CreateChild<Ui::LabelSimple>(
+		container.get(),
+		st::exportFileSizeLabel);
+	value() | rpl::map([](const Settings &data) {
+		return data.media.partsInFlight;
+	}) | rpl::start_with_next([=](int count) {
+		label->setText(tr::lng_export_option_parts_in_flight(
+			tr::now,
+			lt_amount,
+			QString::number(count)));
+	}, slider->lifetime());
+
+	rpl::combine(
+		label->widthValue(),
+		slider->geometryValue(),
+		_2
+	) | rpl::start_with_next([=](QRect geometry) {
+		label->moveToRight(
+			st::exportFileSizePadding.right(),
+			geometry.y() - label->height() - st::exportFileSizeLabelBottom);
+	}, label->lifetime());
+}
+
 void SettingsWidget::refreshButtons(
 		not_null<Ui::RpWidget*> container,
 		bool canStart) {
@@ -798,6 +891,22 @@ void SettingsWidget::chooseFolder() {
 		callback);
 }
 
+void SettingsWidget::choosePreviousCheckpoint() {
+	const auto callback = [=](FileDialog::OpenResult &&result) {
+		if (result.paths.isEmpty()) {
+			return;
+		}
+		changeData([&](Settings &data) {
+			data.previousCheckpoint = result.paths.front();
+		});
+	};
+	FileDialog::GetOpenPath(
+		this,
+		tr::lng_export_choose_previous(tr::now),
+		u"JSON (*.json);;"_q + FileDialog::AllFilesFilter(),
+		crl::guard(this, callback));
+}
+
 rpl::producer<Settings> SettingsWidget::changes() const {
 	return _changes.events();
 }
@@ -82,13 +82,17 @@ private:
 		const QString &text,
 		MediaType type);
 	void addSizeSlider(not_null<Ui::VerticalLayout*> container);
+	void addPartsInFlightSlider(not_null<Ui::VerticalLayout*> container);
 	void addLocationLabel(
 		not_null<Ui::VerticalLayout*> container);
 	void addFormatAndLocationLabel(
 		not_null<Ui::VerticalLayout*> container);
 	void addLimitsLabel(
 		not_null<Ui::VerticalLayout*> container);
+	void addIncrementalOption(
+		not_null<Ui::VerticalLayout*> container);
 	void chooseFolder();
+	void choosePreviousCheckpoint();
 	void chooseFormat();
 	void refreshButtons(
 		not_null<Ui::RpWidget*> container,
@@ -0,0 +1,28 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtGui/QRgb>
+
+namespace FFmpeg {
+
+// Same as qPremultiply() for each pixel, but most of sticker and video
+// pixels are either opaque or transparent, so those are done cheaper.
+inline void PremultiplyPixels(uint *dst, const uint *src, int count) {
+	for (auto i = 0; i != count; ++i) {
+		const auto pixel = src[i];
+		const auto alpha = qAlpha(pixel);
+		dst[i] = (alpha == 255)
+			? pixel
+			: alpha
+			? qPremultiply(pixel)
+			: 0;
+	}
+}
+
+} // namespace FFmpeg
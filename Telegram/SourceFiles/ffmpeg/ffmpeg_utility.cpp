@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "ffmpeg/ffmpeg_utility.h"
 
+#include "ffmpeg/ffmpeg_premultiply.h"
 #include "base/algorithm.h"
 #include "logs.h"
 
@@ -82,9 +83,7 @@ void PremultiplyLine(uchar *dst, const uchar *src, int intsCount) {
 	[[maybe_unused]] const auto usrc = reinterpret_cast<const uint*>(src);
 
 #ifndef LIB_FFMPEG_USE_QT_PRIVATE_API
-	for (auto i = 0; i != intsCount; ++i) {
-		udst[i] = qPremultiply(usrc[i]);
-	}
+	PremultiplyPixels(udst, usrc, intsCount);
 #else // !LIB_FFMPEG_USE_QT_PRIVATE_API
 	static const auto layout = &qPixelLayouts[QImage::Format_ARGB32];
 	layout->fetchToARGB32PM(udst, src, 0, intsCount, nullptr, nullptr);
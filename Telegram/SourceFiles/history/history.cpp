@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "history/history.h"
 
+#include "history/view/history_view_deferred_resize.h"
 #include "history/view/history_view_element.h"
 #include "history/view/history_view_item_preview.h"
 #include "history/view/history_view_translate_tracker.h"
@@ -3015,6 +3016,13 @@ HistoryItem *History::lastEditableMessage() const {
 }
 
 void History::resizeToWidth(int newWidth) {
+	resizeToWidth(newWidth, 0, std::numeric_limits<int>::max());
+}
+
+void History::resizeToWidth(
+		int newWidth,
+		int visibleTop,
+		int visibleBottom) {
 	using Request = HistoryBlock::ResizeRequest;
 	const auto request = (_flags & Flag::PendingAllItemsResize)
 		? Request::ReinitAll
@@ -3024,17 +3032,84 @@ void History::resizeToWidth(int newWidth) {
 	if (request == Request::ResizePending && !hasPendingResizedItems()) {
 		return;
 	}
-	_flags &= ~(Flag::HasPendingResizedItems | Flag::PendingAllItemsResize);
+	_flags &= ~(Flag::HasPendingResizedItems
+		| Flag::PendingAllItemsResize);
+	if (request != Request::ResizePending) {
+		_flags &= ~Flag::HasDeferredResizedItems;
+	}
 
+	// Without a previous layout there are no heights to estimate with.
+	if (request != Request::ResizeAll || !_width) {
+		visibleTop = 0;
+		visibleBottom = std::numeric_limits<int>::max();
+	}
 	_width = newWidth;
 	int y = 0;
 	for (const auto &block : blocks) {
+		const auto wasTop = block->y();
 		block->setY(y);
-		y += block->resizeGetHeight(newWidth, request);
+		y += block->resizeGetHeight(
+			newWidth,
+			request,
+			visibleTop - wasTop,
+			visibleBottom - wasTop);
 	}
 	_height = y;
 }
 
+bool History::hasDeferredResizedItems() const {
+	return _flags & Flag::HasDeferredResizedItems;
+}
+
+bool History::hasDeferredResizedItems(int top, int bottom) const {
+	if (!(_flags & Flag::HasDeferredResizedItems)) {
+		return false;
+	}
+	return HistoryView::EnumerateDeferredElements(
+		blocks,
+		top,
+		bottom,
+		[](not_null<Element*>) { return false; });
+}
+
+void History::setHasDeferredResizedItems() {
+	_flags |= Flag::HasDeferredResizedItems;
+}
+
+void History::resizeDeferredItems(int top, int bottom) {
+	if (!(_flags & Flag::HasDeferredResizedItems)) {
+		return;
+	}
+	const auto resized = HistoryView::EnumerateDeferredElements(
+		blocks,
+		top,
+		bottom,
+		[&](not_null<Element*> view) {
+			view->resizeGetHeight(_width);
+			return true;
+		});
+	if (resized) {
+		_flags |= Flag::HasPendingResizedItems;
+	}
+}
+
+void History::resizeDeferredItemsChunk(crl::time deadline) {
+	if (!(_flags & Flag::HasDeferredResizedItems)) {
+		return;
+	}
+	const auto chunk = HistoryView::ResizeDeferredElements(
+		blocks,
+		_width,
+		deadline,
+		crl::now);
+	if (chunk.finished) {
+		_flags &= ~Flag::HasDeferredResizedItems;
+	}
+	if (chunk.resized > 0) {
+		_flags |= Flag::HasPendingResizedItems;
+	}
+}
+
 void History::forceFullResize() {
 	_width = 0;
 	_flags |= Flag::HasPendingResizedItems;
@@ -3581,7 +3656,11 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 : _history(history) {
 }
 
-int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
+int HistoryBlock::resizeGetHeight(
+		int newWidth,
+		ResizeRequest request,
+		int visibleTop,
+		int visibleBottom) {
 	auto y = 0;
 	if (request == ResizeRequest::ReinitAll) {
 		for (const auto &message : messages) {
@@ -3590,10 +3669,11 @@ int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
 			y += message->resizeGetHeight(newWidth);
 		}
 	} else if (request == ResizeRequest::ResizeAll) {
-		for (const auto &message : messages) {
-			message->setY(y);
-			y += message->resizeGetHeight(newWidth);
-		}
+		y = HistoryView::ResizeVisibleElements(
+			messages,
+			newWidth,
+			visibleTop,
+			visibleBottom);
 	} else {
 		for (const auto &message : messages) {
 			message->setY(y);
@@ -280,6 +280,18 @@ public:
 	HistoryItem *lastEditableMessage() const;
 
 	void resizeToWidth(int newWidth);
+
+	// On a width change only elements intersecting [visibleTop,
+	// visibleBottom) are resized, others keep their heights as estimates
+	// until resizeDeferredItems() or resizeDeferredItemsChunk() get to
+	// them. Both leave the positions to the next pending resize pass.
+	void resizeToWidth(int newWidth, int visibleTop, int visibleBottom);
+	[[nodiscard]] bool hasDeferredResizedItems() const;
+	[[nodiscard]] bool hasDeferredResizedItems(int top, int bottom) const;
+	void setHasDeferredResizedItems();
+	void resizeDeferredItems(int top, int bottom);
+	void resizeDeferredItemsChunk(crl::time deadline);
+
 	void forceFullResize();
 	int height() const;
 
@@ -455,6 +467,7 @@ private:
 		FakeUnreadWhileOpened = (1 << 4),
 		HasPinnedMessages = (1 << 5),
 		ResolveChatListMessage = (1 << 6),
+		HasDeferredResizedItems = (1 << 7),
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) {
@@ -651,7 +664,11 @@ public:
 	void remove(not_null<Element*> view);
 	void refreshView(not_null<Element*> view);
 
-	int resizeGetHeight(int newWidth, ResizeRequest request);
+	int resizeGetHeight(
+		int newWidth,
+		ResizeRequest request,
+		int visibleTop,
+		int visibleBottom);
 	int y() const {
 		return _y;
 	}
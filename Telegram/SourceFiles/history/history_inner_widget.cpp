@@ -1017,8 +1017,11 @@ void HistoryInner::startEffectOnRead(not_null<HistoryItem*> item) {
 }
 
 void HistoryInner::paintEvent(QPaintEvent *e) {
-	if (_controller->contentOverlapped(this, e)
-		|| hasPendingResizedItems()) {
+	if (_controller->contentOverlapped(this, e)) {
+		return;
+	} else if (requestResizeVisibleDeferredItems()) {
+		return;
+	} else if (hasPendingResizedItems()) {
 		return;
 	} else if (_recountedAfterPendingResizedItems) {
 		_recountedAfterPendingResizedItems = false;
@@ -3303,10 +3306,24 @@ void HistoryInner::recountHistoryGeometry() {
 
 	updateBotInfo(false);
 
-	_history->resizeToWidth(_contentWidth);
+	// Lay out the visible area with one more screen around it right away,
+	// the rest is resized in idle chunks or when it comes into view,
+	// see HistoryWidget::resizeDeferredItemsChunk().
+	const auto resize = [&](not_null<History*> history, int top) {
+		if (top < 0) {
+			history->resizeToWidth(_contentWidth);
+		} else {
+			history->resizeToWidth(
+				_contentWidth,
+				_visibleAreaTop - visibleHeight - top,
+				_visibleAreaBottom + visibleHeight - top);
+		}
+	};
+	const auto historyWasTop = historyTop();
 	if (_migrated) {
-		_migrated->resizeToWidth(_contentWidth);
+		resize(_migrated, migratedTop());
 	}
+	resize(_history, historyWasTop);
 
 	// With migrated history we perhaps do not need to display
 	// the first _history message date (just skip it by height).
@@ -3904,7 +3921,7 @@ auto HistoryInner::reactionButtonParameters(
 }
 
 void HistoryInner::mouseActionUpdate() {
-	if (hasPendingResizedItems()) {
+	if (requestResizeVisibleDeferredItems() || hasPendingResizedItems()) {
 		return;
 	}
 
@@ -4542,6 +4559,40 @@ bool HistoryInner::hasPendingResizedItems() const {
 		|| (_migrated && _migrated->hasPendingResizedItems());
 }
 
+bool HistoryInner::hasDeferredResizedItems(int top, int bottom) const {
+	const auto check = [&](History *history, int historyTop) {
+		return history
+			&& (historyTop >= 0)
+			&& history->hasDeferredResizedItems(
+				top - historyTop,
+				bottom - historyTop);
+	};
+	return check(_migrated, migratedTop())
+		|| check(_history, historyTop());
+}
+
+void HistoryInner::resizeVisibleDeferredItems() {
+	const auto resize = [&](History *history, int historyTop) {
+		if (history && historyTop >= 0) {
+			history->resizeDeferredItems(
+				_visibleAreaTop - historyTop,
+				_visibleAreaBottom - historyTop);
+		}
+	};
+	resize(_migrated, migratedTop());
+	resize(_history, historyTop());
+}
+
+bool HistoryInner::requestResizeVisibleDeferredItems() {
+	if (!hasDeferredResizedItems(_visibleAreaTop, _visibleAreaBottom)) {
+		return false;
+	}
+	// The resize changes the geometry and the scroll position,
+	// so it is posted and this frame is skipped.
+	_widget->requestResizeVisibleDeferredItems();
+	return true;
+}
+
 void HistoryInner::deleteAsGroup(FullMsgId itemId) {
 	if (const auto item = session().data().message(itemId)) {
 		const auto group = session().data().groups().find(item);
@@ -122,6 +122,8 @@ public:
 	void changeItemsRevealHeight(int revealHeight);
 	void checkActivation();
 	void recountHistoryGeometry();
+	[[nodiscard]] bool hasDeferredResizedItems(int top, int bottom) const;
+	void resizeVisibleDeferredItems();
 	void updateSize();
 	void setShownPinned(HistoryItem *item);
 
@@ -440,6 +442,10 @@ private:
 	// Does any of the shown histories has this flag set.
 	bool hasPendingResizedItems() const;
 
+	// Elements left with a stale layout after a width change
+	// must be resized before they're painted or hit-tested.
+	bool requestResizeVisibleDeferredItems();
+
 	const not_null<HistoryWidget*> _widget;
 	const not_null<Ui::ScrollArea*> _scroll;
 	const not_null<Window::SessionController*> _controller;
@@ -182,6 +182,9 @@ constexpr auto kMessagesPerPage = 50;
 constexpr auto kPreloadHeightsCount = 3; // when 3 screens to scroll left make a preload request
 constexpr auto kScrollToVoiceAfterScrolledMs = 1000;
 constexpr auto kSkipRepaintWhileScrollMs = 100;
+constexpr auto kResizeDeferredTimeout = crl::time(200);
+constexpr auto kResizeDeferredChunkDuration = crl::time(8);
+constexpr auto kResizeDeferredChunkDelay = crl::time(16);
 constexpr auto kShowMembersDropdownTimeoutMs = 300;
 constexpr auto kDisplayEditTimeWarningMs = 300 * 1000;
 constexpr auto kFullDayInMs = 86400 * 1000;
@@ -234,6 +237,7 @@ HistoryWidget::HistoryWidget(
 	controller->chatStyle()->value(lifetime(), st::historyScroll),
 	false)
 , _updateHistoryItems([=] { updateHistoryItemsByTimer(); })
+, _resizeDeferredTimer([=] { resizeDeferredItemsChunk(); })
 , _cornerButtons(
 	_scroll.data(),
 	controller->chatStyle(),
@@ -3835,6 +3839,9 @@ void HistoryWidget::visibleAreaUpdated() {
 	if (_list && !_scroll->isHidden()) {
 		const auto scrollTop = _scroll->scrollTop();
 		const auto scrollBottom = scrollTop + _scroll->height();
+		if (_list->hasDeferredResizedItems(scrollTop, scrollBottom)) {
+			requestResizeVisibleDeferredItems();
+		}
 		_list->visibleAreaUpdated(scrollTop, scrollBottom);
 		controller()->floatPlayerAreaUpdated();
 		session().data().itemVisibilitiesUpdated();
@@ -5919,6 +5926,40 @@ void HistoryWidget::handlePendingHistoryUpdate() {
 	}
 }
 
+void HistoryWidget::requestResizeVisibleDeferredItems() {
+	if (_resizeVisibleDeferredRequested) {
+		return;
+	}
+	_resizeVisibleDeferredRequested = true;
+	crl::on_main(this, [=] {
+		_resizeVisibleDeferredRequested = false;
+		if (!_list) {
+			return;
+		}
+		_list->resizeVisibleDeferredItems();
+		handlePendingHistoryUpdate();
+
+		// The frame that requested it was skipped.
+		_list->update();
+	});
+}
+
+void HistoryWidget::resizeDeferredItemsChunk() {
+	if (!_list || !_history) {
+		return;
+	}
+	const auto deadline = crl::now() + kResizeDeferredChunkDuration;
+	_history->resizeDeferredItemsChunk(deadline);
+	if (_migrated && crl::now() < deadline) {
+		_migrated->resizeDeferredItemsChunk(deadline);
+	}
+	handlePendingHistoryUpdate();
+	if (_history->hasDeferredResizedItems()
+		|| (_migrated && _migrated->hasDeferredResizedItems())) {
+		_resizeDeferredTimer.callOnce(kResizeDeferredChunkDelay);
+	}
+}
+
 void HistoryWidget::resizeEvent(QResizeEvent *e) {
 	//updateTabbedSelectorSectionShown();
 	recountChatWidth();
@@ -6398,6 +6439,12 @@ void HistoryWidget::updateListSize() {
 		_scroll->hide();
 	}
 	_updateHistoryGeometryRequired = true;
+
+	if (!_resizeDeferredTimer.isActive()
+		&& (_history->hasDeferredResizedItems()
+			|| (_migrated && _migrated->hasDeferredResizedItems()))) {
+		_resizeDeferredTimer.callOnce(kResizeDeferredTimeout);
+	}
 }
 
 bool HistoryWidget::hasPendingResizedItems() const {
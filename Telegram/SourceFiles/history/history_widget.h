@@ -187,6 +187,10 @@ public:
 
 	QPoint clampMousePosition(QPoint point);
 
+	// Lay out the elements postponed by a width change that came into
+	// view, posted because it changes the geometry and the scroll.
+	void requestResizeVisibleDeferredItems();
+
 	bool touchScroll(const QPoint &delta);
 
 	void enqueueMessageHighlight(const HistoryView::SelectedQuote &quote);
@@ -401,6 +405,7 @@ private:
 	[[nodiscard]] SendMenu::Details sendButtonMenuDetails() const;
 	[[nodiscard]] SendMenu::Details sendButtonDefaultDetails() const;
 	void handlePendingHistoryUpdate();
+	void resizeDeferredItemsChunk();
 	void fullInfoUpdated();
 	void toggleTabbedSelectorMode();
 	void recountChatWidth();
@@ -729,6 +734,8 @@ private:
 	int _lastScrollTop = 0; // gifs optimization
 	crl::time _lastScrolled = 0;
 	base::Timer _updateHistoryItems;
+	base::Timer _resizeDeferredTimer;
+	bool _resizeVisibleDeferredRequested = false;
 
 	crl::time _lastUserScrolled = 0;
 	bool _synteticScrollEvent = false;
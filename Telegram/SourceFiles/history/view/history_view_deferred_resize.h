@@ -0,0 +1,111 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "crl/crl_time.h"
+
+#include <iterator>
+
+namespace HistoryView {
+
+// On a width change only the elements intersecting the visible range are
+// resized, others keep their heights as estimates and are marked with
+// setDeferredResize(). They are resized later, either when they come
+// into view or in time-limited chunks while the history is idle.
+//
+// Blocks are y() / height() / messages, elements are y() / setY() /
+// height() / resizeGetHeight() / pendingResize() / deferredResize().
+
+// Lays out block elements for a new width, returns the block height.
+// The range is in block coordinates, as it was before the width change.
+template <typename Elements>
+[[nodiscard]] int ResizeVisibleElements(
+		const Elements &elements,
+		int newWidth,
+		int visibleTop,
+		int visibleBottom) {
+	auto y = 0;
+	for (const auto &element : elements) {
+		const auto wasTop = element->y();
+		const auto height = element->height();
+		element->setY(y);
+		if (element->pendingResize()
+			|| (wasTop + height > visibleTop && wasTop < visibleBottom)) {
+			y += element->resizeGetHeight(newWidth);
+		} else {
+			element->setDeferredResize();
+			y += height;
+		}
+	}
+	return y;
+}
+
+// Calls method(element) for the deferred elements intersecting
+// [top, bottom) until it returns false, returns true if it was called.
+template <typename Blocks, typename Method>
+bool EnumerateDeferredElements(
+		const Blocks &blocks,
+		int top,
+		int bottom,
+		Method &&method) {
+	auto result = false;
+	for (const auto &block : blocks) {
+		const auto blockTop = block->y();
+		if (blockTop >= bottom) {
+			break;
+		} else if (blockTop + block->height() <= top) {
+			continue;
+		}
+		for (const auto &element : block->messages) {
+			const auto elementTop = blockTop + element->y();
+			if (elementTop >= bottom) {
+				break;
+			} else if (elementTop + element->height() <= top
+				|| !element->deferredResize()) {
+				continue;
+			}
+			result = true;
+			if (!method(element.get())) {
+				return result;
+			}
+		}
+	}
+	return result;
+}
+
+struct DeferredResizeChunk {
+	int resized = 0;
+	bool finished = false;
+};
+
+// Resizes deferred elements from the bottom up until now() reaches the
+// deadline. The element positions must be recounted afterwards.
+template <typename Blocks, typename Now>
+[[nodiscard]] DeferredResizeChunk ResizeDeferredElements(
+		const Blocks &blocks,
+		int newWidth,
+		crl::time deadline,
+		Now &&now) {
+	auto result = DeferredResizeChunk();
+	for (auto b = rbegin(blocks); b != rend(blocks); ++b) {
+		const auto &elements = (*b)->messages;
+		for (auto e = rbegin(elements); e != rend(elements); ++e) {
+			if (!(*e)->deferredResize()) {
+				continue;
+			} else if (result.resized > 0 && now() >= deadline) {
+				return result;
+			}
+			(*e)->resizeGetHeight(newWidth);
+			++result.resized;
+		}
+	}
+	result.finished = true;
+	return result;
+}
+
+} // namespace HistoryView
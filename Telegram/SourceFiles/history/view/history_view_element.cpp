@@ -671,6 +671,17 @@ bool Element::pendingResize() const {
 	return _flags & Flag::NeedsResize;
 }
 
+void Element::setDeferredResize() {
+	_flags |= Flag::DeferredResize;
+	if (_context == Context::History) {
+		data()->_history->setHasDeferredResizedItems();
+	}
+}
+
+bool Element::deferredResize() const {
+	return _flags & Flag::DeferredResize;
+}
+
 bool Element::isAttachedToPrevious() const {
 	return _flags & Flag::AttachedToPrevious;
 }
@@ -723,8 +734,7 @@ void Element::overrideMedia(std::unique_ptr<Media> media) {
 	Expects(!history()->owner().groups().find(data()));
 
 	_text = Ui::Text::String(st::msgMinWidth);
-	_textWidth = -1;
-	_textHeight = 0;
+	clearTextHeights();
 
 	_media = std::move(media);
 	if (!pendingResize()) {
@@ -856,11 +866,23 @@ OnlyEmojiAndSpaces Element::isOnlyEmojiAndSpaces() const {
 
 int Element::textHeightFor(int textWidth) {
 	validateText();
-	if (_textWidth != textWidth) {
-		_textWidth = textWidth;
-		_textHeight = _text.countHeight(textWidth);
+
+	// Keep a few recently used widths, so that switching between
+	// layouts (bubble / wide, resize back and forth) doesn't relayout.
+	const auto b = begin(_textHeights);
+	const auto e = end(_textHeights);
+	const auto i = ranges::find(_textHeights, textWidth, &TextHeight::width);
+	if (i != e) {
+		std::rotate(b, i, i + 1);
+	} else {
+		std::rotate(b, e - 1, e);
+		*b = { textWidth, _text.countHeight(textWidth) };
 	}
-	return _textHeight;
+	return b->height;
+}
+
+void Element::clearTextHeights() {
+	_textHeights.fill(TextHeight());
 }
 
 auto Element::contextDependentServiceText() -> TextWithLinks {
@@ -1082,20 +1104,17 @@ void Element::setTextWithLinks(
 		}
 	}
 	InitElementTextPart(this, _text);
-	_textWidth = -1;
-	_textHeight = 0;
+	clearTextHeights();
 }
 
 void Element::validateTextSkipBlock(bool has, int width, int height) {
 	validateText();
 	if (!has) {
 		if (_text.removeSkipBlock()) {
-			_textWidth = -1;
-			_textHeight = 0;
+			clearTextHeights();
 		}
 	} else if (_text.updateSkipBlock(width, height)) {
-		_textWidth = -1;
-		_textHeight = 0;
+		clearTextHeights();
 	}
 }
 
@@ -1293,6 +1312,7 @@ QSize Element::countCurrentSize(int newWidth) {
 	if (_flags & Flag::NeedsResize) {
 		initDimensions();
 	}
+	_flags &= ~Flag::DeferredResize;
 	return performCountCurrentSize(newWidth);
 }
 
@@ -1513,16 +1533,14 @@ void Element::itemTextUpdated() {
 	}
 	clearSpecialOnlyEmoji();
 	_text = Ui::Text::String(st::msgMinWidth);
-	_textWidth = -1;
-	_textHeight = 0;
+	clearTextHeights();
 	if (_media && !data()->media()) {
 		refreshMedia(nullptr);
 	}
 }
 
 void Element::blockquoteExpandChanged() {
-	_textWidth = -1;
-	_textHeight = 0;
+	clearTextHeights();
 	history()->owner().requestViewResize(this);
 }
 
@@ -327,6 +327,7 @@ public:
 		TopicRootReply           = 0x0400,
 		MediaOverriden           = 0x0800,
 		HeavyCustomEmoji         = 0x1000,
+		DeferredResize           = 0x2000,
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) { return true; }
@@ -356,6 +357,8 @@ public:
 
 	void setPendingResize();
 	[[nodiscard]] bool pendingResize() const;
+	void setDeferredResize();
+	[[nodiscard]] bool deferredResize() const;
 	[[nodiscard]] bool isUnderCursor() const;
 
 	[[nodiscard]] bool isLastAndSelfMessage() const;
@@ -610,6 +613,7 @@ protected:
 
 	[[nodiscard]] const Ui::Text::String &text() const;
 	[[nodiscard]] int textHeightFor(int textWidth);
+	void clearTextHeights();
 	void validateText();
 	void validateTextSkipBlock(bool has, int width, int height);
 
@@ -656,8 +660,11 @@ private:
 
 	HistoryItem *_textItem = nullptr;
 	mutable Ui::Text::String _text;
-	mutable int _textWidth = -1;
-	mutable int _textHeight = 0;
+	struct TextHeight {
+		int width = -1;
+		int height = 0;
+	};
+	mutable std::array<TextHeight, 3> _textHeights;
 
 	int _y = 0;
 	int _indexInBlock = -1;
@@ -528,23 +528,44 @@ void Sticker::setWebpagePart() {
 	_webpagePart = true;
 }
 
+bool Sticker::canSharePlayer() const {
+	// Only looping stickers may show frames of someone else's animation.
+	return (_diceIndex < 0)
+		&& !emojiSticker()
+		&& !customEmojiPart()
+		&& !hasPremiumEffect()
+		&& Core::App().settings().loopAnimatedStickers();
+}
+
 void Sticker::setupPlayer() {
 	Expects(_dataMedia != nullptr);
 
-	if (_data->sticker()->isLottie()) {
-		_player = std::make_unique<LottiePlayer>(
-			ChatHelpers::LottiePlayerFromDocument(
-				_dataMedia.get(),
-				_replacements,
-				_cachingTag,
-				countOptimalSize() * style::DevicePixelRatio(),
-				Lottie::Quality::High));
-	} else if (_data->sticker()->isWebm()) {
-		_player = std::make_unique<WebmPlayer>(
-			_dataMedia->owner()->location(),
-			_dataMedia->bytes(),
-			countOptimalSize());
-	}
+	const auto create = [&]() -> std::unique_ptr<StickerPlayer> {
+		if (_data->sticker()->isLottie()) {
+			return std::make_unique<LottiePlayer>(
+				ChatHelpers::LottiePlayerFromDocument(
+					_dataMedia.get(),
+					_replacements,
+					_cachingTag,
+					countOptimalSize() * style::DevicePixelRatio(),
+					Lottie::Quality::High));
+		} else if (_data->sticker()->isWebm()) {
+			return std::make_unique<WebmPlayer>(
+				_dataMedia->owner()->location(),
+				_dataMedia->bytes(),
+				countOptimalSize());
+		}
+		return nullptr;
+	};
+	_player = canSharePlayer()
+		? SharedStickerPlayer::Make({
+			.document = _data,
+			.cachingTag = _cachingTag,
+			.size = countOptimalSize(),
+			.ratio = style::DevicePixelRatio(),
+			.replacements = _replacements,
+		}, create)
+		: create();
 
 	checkPremiumEffectStart();
 	playerCreated();
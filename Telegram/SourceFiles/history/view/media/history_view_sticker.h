@@ -113,6 +113,7 @@ private:
 	void ensureDataMediaCreated() const;
 	void dataMediaCreated() const;
 
+	[[nodiscard]] bool canSharePlayer() const;
 	void setupPlayer();
 	void playerCreated();
 	void unloadPlayer();
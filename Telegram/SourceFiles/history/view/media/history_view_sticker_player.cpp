@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/media/history_view_sticker_player.h"
 
 #include "core/file_location.h"
+#include "ui/image/image_prepare.h"
 
 namespace HistoryView {
 namespace {
@@ -116,6 +117,95 @@ bool WebmPlayer::markFrameShown() {
 	return _reader->moveToNextFrame();
 }
 
+struct SharedStickerPlayer::Shared {
+	std::unique_ptr<StickerPlayer> player;
+	std::vector<not_null<SharedStickerPlayer*>> users;
+};
+
+std::unique_ptr<StickerPlayer> SharedStickerPlayer::Make(
+		Key key,
+		FnMut<std::unique_ptr<StickerPlayer>()> create) {
+	static auto Players = base::flat_map<Key, std::weak_ptr<Shared>>();
+
+	for (auto i = begin(Players); i != end(Players);) {
+		if (i->second.expired()) {
+			i = Players.erase(i);
+		} else {
+			++i;
+		}
+	}
+	auto &weak = Players[key];
+	auto shared = weak.lock();
+	if (!shared) {
+		auto player = create();
+		if (!player) {
+			return nullptr;
+		}
+		shared = std::make_shared<Shared>();
+		shared->player = std::move(player);
+		weak = shared;
+
+		const auto raw = shared.get();
+		raw->player->setRepaintCallback([=] {
+			for (const auto user : base::duplicate(raw->users)) {
+				if (const auto &callback = user->_repaintCallback) {
+					callback();
+				}
+			}
+		});
+	}
+	return std::unique_ptr<StickerPlayer>(
+		new SharedStickerPlayer(std::move(shared)));
+}
+
+SharedStickerPlayer::SharedStickerPlayer(std::shared_ptr<Shared> shared)
+: _shared(std::move(shared)) {
+	_shared->users.push_back(this);
+}
+
+SharedStickerPlayer::~SharedStickerPlayer() {
+	_shared->users.erase(
+		ranges::remove(_shared->users, not_null(this)),
+		end(_shared->users));
+}
+
+void SharedStickerPlayer::setRepaintCallback(Fn<void()> callback) {
+	_repaintCallback = std::move(callback);
+}
+
+bool SharedStickerPlayer::ready() {
+	return _shared->player->ready();
+}
+
+int SharedStickerPlayer::framesCount() {
+	return _shared->player->framesCount();
+}
+
+SharedStickerPlayer::FrameInfo SharedStickerPlayer::frame(
+		QSize size,
+		QColor colored,
+		bool mirrorHorizontal,
+		crl::time now,
+		bool paused) {
+	// Request the same frame for all the views, color it separately.
+	auto result = _shared->player->frame(
+		size,
+		QColor(0, 0, 0, 0),
+		mirrorHorizontal,
+		now,
+		paused);
+	if (colored.alpha() != 0 && !result.image.isNull()) {
+		result.image = Images::Colored(
+			base::duplicate(result.image),
+			colored);
+	}
+	return result;
+}
+
+bool SharedStickerPlayer::markFrameShown() {
+	return _shared->player->markFrameShown();
+}
+
 StaticStickerPlayer::StaticStickerPlayer(
 	const Core::FileLocation &location,
 	const QByteArray &data,
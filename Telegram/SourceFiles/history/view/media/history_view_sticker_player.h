@@ -16,6 +16,12 @@ namespace Core {
 class FileLocation;
 } // namespace Core
 
+namespace ChatHelpers {
+enum class StickerLottieSize : uint8;
+} // namespace ChatHelpers
+
+class DocumentData;
+
 namespace HistoryView {
 
 class LottiePlayer final : public StickerPlayer {
@@ -66,6 +72,61 @@ private:
 
 };
 
+// Plays one animation for all the views of the same sticker
+// painted in the same size, so that each frame is rendered only once.
+class SharedStickerPlayer final : public StickerPlayer {
+public:
+	struct Key {
+		not_null<DocumentData*> document;
+		ChatHelpers::StickerLottieSize cachingTag = {};
+		QSize size; // The size frame() is requested with.
+		int ratio = 0;
+		const Lottie::ColorReplacements *replacements = nullptr;
+
+		friend inline bool operator<(const Key &a, const Key &b) {
+			return std::tuple(
+				a.document.get(),
+				a.cachingTag,
+				a.size.width(),
+				a.size.height(),
+				a.ratio,
+				a.replacements
+			) < std::tuple(
+				b.document.get(),
+				b.cachingTag,
+				b.size.width(),
+				b.size.height(),
+				b.ratio,
+				b.replacements);
+		}
+	};
+	[[nodiscard]] static std::unique_ptr<StickerPlayer> Make(
+		Key key,
+		FnMut<std::unique_ptr<StickerPlayer>()> create);
+
+	~SharedStickerPlayer();
+
+	void setRepaintCallback(Fn<void()> callback) override;
+	bool ready() override;
+	int framesCount() override;
+	FrameInfo frame(
+		QSize size,
+		QColor colored,
+		bool mirrorHorizontal,
+		crl::time now,
+		bool paused) override;
+	bool markFrameShown() override;
+
+private:
+	struct Shared;
+
+	explicit SharedStickerPlayer(std::shared_ptr<Shared> shared);
+
+	const std::shared_ptr<Shared> _shared;
+	Fn<void()> _repaintCallback;
+
+};
+
 class StaticStickerPlayer final : public StickerPlayer {
 public:
 	StaticStickerPlayer(
@@ -16,10 +16,50 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Iv {
 namespace {
 
+constexpr auto kPreparedCacheLimit = 4;
+
 bool FailureRecorded/* = false*/;
 
 } // namespace
 
+struct Data::PreparedCache {
+	QMutex mutex;
+	std::optional<Prepared> result;
+	Options options;
+	int views = 0;
+
+	// The prepared HTML may be large, keep only a few last used ones.
+	static void Used(const std::shared_ptr<PreparedCache> &cache);
+
+	static QMutex AllMutex;
+	static std::vector<std::weak_ptr<PreparedCache>> All;
+};
+
+QMutex Data::PreparedCache::AllMutex;
+std::vector<std::weak_ptr<Data::PreparedCache>> Data::PreparedCache::All;
+
+void Data::PreparedCache::Used(const std::shared_ptr<PreparedCache> &cache) {
+	auto dropped = std::vector<std::shared_ptr<PreparedCache>>();
+	{
+		QMutexLocker lock(&AllMutex);
+		All.erase(ranges::remove_if(All, [&](const auto &weak) {
+			const auto strong = weak.lock();
+			return !strong || (strong == cache);
+		}), end(All));
+		All.insert(begin(All), cache);
+		while (int(All.size()) > kPreparedCacheLimit) {
+			if (auto strong = All.back().lock()) {
+				dropped.push_back(std::move(strong));
+			}
+			All.pop_back();
+		}
+	}
+	for (const auto &entry : dropped) {
+		QMutexLocker lock(&entry->mutex);
+		entry->result = std::nullopt;
+	}
+}
+
 QByteArray GeoPointId(Geo point) {
 	const auto lat = int(point.lat * 1000000);
 	const auto lon = int(point.lon * 1000000);
@@ -58,7 +98,8 @@ Data::Data(const MTPDwebPage &webpage, const MTPPage &page)
 	.name = (webpage.vsite_name()
 		? qs(*webpage.vsite_name())
 		: SiteNameFromUrl(qs(webpage.vurl())))
-})) {
+}))
+, _prepared(std::make_shared<PreparedCache>()) {
 }
 
 QString Data::id() const {
@@ -78,8 +119,38 @@ void Data::updateCachedViews(int cachedViews) {
 }
 
 void Data::prepare(const Options &options, Fn<void(Prepared)> done) const {
-	crl::async([source = *_source, options, done = std::move(done)] {
-		done(Prepare(source, options));
+	const auto views = _source->updatedCachedViews;
+	auto cached = std::optional<Prepared>();
+	{
+		// The page itself never changes for a given Data, only the
+		// views counter and the options rendered into the content do.
+		QMutexLocker lock(&_prepared->mutex);
+		if (_prepared->result
+			&& _prepared->views == views
+			&& _prepared->options == options) {
+			cached = *_prepared->result;
+		}
+	}
+	if (cached) {
+		PreparedCache::Used(_prepared);
+		done(std::move(*cached));
+		return;
+	}
+	crl::async([
+		source = *_source,
+		options,
+		cache = _prepared,
+		done = std::move(done)
+	] {
+		auto result = Prepare(source, options);
+		{
+			QMutexLocker lock(&cache->mutex);
+			cache->result = result;
+			cache->options = options;
+			cache->views = source.updatedCachedViews;
+		}
+		PreparedCache::Used(cache);
+		done(std::move(result));
 	});
 }
 
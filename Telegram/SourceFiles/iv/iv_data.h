@@ -12,6 +12,9 @@ namespace Iv {
 struct Source;
 
 struct Options {
+	friend inline bool operator==(
+		const Options &,
+		const Options &) = default;
 };
 
 struct Prepared {
@@ -50,7 +53,10 @@ public:
 	void prepare(const Options &options, Fn<void(Prepared)> done) const;
 
 private:
+	struct PreparedCache;
+
 	const std::unique_ptr<Source> _source;
+	const std::shared_ptr<PreparedCache> _prepared;
 
 };
 
@@ -12,10 +12,20 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/launcher.h"
 #include "mtproto/facade.h"
 
+#ifdef Q_OS_WIN
+#include <io.h>
+#else // Q_OS_WIN
+#include <unistd.h>
+#endif // Q_OS_WIN
+
 namespace {
 
+// Debug log writers write the pending entries themselves above that.
+constexpr auto kMaxPendingDebugBytes = 16 * 1024 * 1024;
+
 std::atomic<int> ThreadCounter/* = 0*/;
 thread_local bool WritingEntryFlag/* = false*/;
+thread_local bool WritingPendingFlag/* = false*/;
 
 class WritingEntryScope final {
 public:
@@ -27,6 +37,22 @@ public:
 	}
 };
 
+// Doesn't allocate, so it can be used in the crash handler.
+void WriteToHandle(int handle, const char *data, int size) {
+	while (size > 0) {
+#ifdef Q_OS_WIN
+		const auto written = _write(handle, data, size);
+#else // Q_OS_WIN
+		const auto written = int(::write(handle, data, size));
+#endif // Q_OS_WIN
+		if (written <= 0) {
+			return;
+		}
+		data += written;
+		size -= written;
+	}
+}
+
 } // namespace
 
 enum LogDataType {
@@ -79,6 +105,11 @@ public:
 		}
 	}
 
+	~LogsDataFields() {
+		_writer.sync([] {});
+		writePending();
+	}
+
 	bool openMain() {
 		return reopen(LogDataMain, 0, u"start"_q);
 	}
@@ -111,12 +142,13 @@ public:
 	}
 
 	void write(LogDataType type, const QString &msg) {
+		if (type != LogDataMain) {
+			enqueueDebug(type, msg.toUtf8());
+			return;
+		}
 		QMutexLocker lock(_logsMutex(type));
 		WritingEntryScope scope;
 
-		if (type != LogDataMain) {
-			reopenDebug();
-		}
 		const auto file = files[type].get();
 		if (!file || !file->isOpen()) {
 			return;
@@ -125,9 +157,79 @@ public:
 		file->flush();
 	}
 
+	// Writes the pending debug entries in the order they were added.
+	void writePending() {
+		QMutexLocker writing(&_writingMutex);
+		WritingPendingFlag = true;
+
+		QByteArray batch[LogDataCount];
+		{
+			QMutexLocker lock(&_pendingMutex);
+			for (auto i = 0; i != LogDataCount; ++i) {
+				std::swap(batch[i], _pending[i]);
+			}
+			_pendingBytes = 0;
+		}
+		for (auto i = 0; i != LogDataCount; ++i) {
+			const auto type = LogDataType(i);
+			if (batch[i].isEmpty()) {
+				continue;
+			}
+			QMutexLocker lock(_logsMutex(type));
+			WritingEntryScope scope;
+
+			reopenDebug();
+			const auto file = files[type].get();
+			if (file && file->isOpen()) {
+				file->write(batch[i]);
+				file->flush();
+			}
+		}
+
+		WritingPendingFlag = false;
+	}
+
+	// The crashed thread may hold any of the locks and the heap may be
+	// broken, so nothing is reopened, allocated or freed here. Pending
+	// entries go straight to the already open files, the ones that can't
+	// be written without waiting for a lock are dropped.
+	void writePendingAfterCrash() {
+		if (!_writingMutex.tryLock()) {
+			return;
+		} else if (!_pendingMutex.tryLock()) {
+			_writingMutex.unlock();
+			return;
+		}
+		for (auto i = 0; i != LogDataCount; ++i) {
+			const auto type = LogDataType(i);
+			const auto &pending = _pending[i];
+			if (pending.isEmpty() || !_logsMutex(type)->tryLock()) {
+				continue;
+			}
+			const auto file = files[type].get();
+			const auto handle = (file && file->isOpen())
+				? file->handle()
+				: -1;
+			if (handle >= 0) {
+				WriteToHandle(handle, pending.constData(), pending.size());
+			}
+			_logsMutex(type)->unlock();
+		}
+		_pendingMutex.unlock();
+		_writingMutex.unlock();
+	}
+
 private:
 	std::unique_ptr<QFile> files[LogDataCount];
 
+	// Debug, tcp and mtp entries are written and flushed in batches
+	// on _writer, so that logging threads don't wait for the disk.
+	crl::queue _writer;
+	QMutex _pendingMutex;
+	QByteArray _pending[LogDataCount];
+	int _pendingBytes = 0;
+	QMutex _writingMutex;
+
 	int32 part = -1;
 
 	bool reopen(LogDataType type, int32 dayIndex, const QString &postfix) {
@@ -230,6 +332,27 @@ NEW LOGGING INSTANCE STARTED!!!\n\
 		return false;
 	}
 
+	void enqueueDebug(LogDataType type, QByteArray &&utf8) {
+		auto schedule = false;
+		auto overflow = false;
+		{
+			QMutexLocker lock(&_pendingMutex);
+			WritingEntryScope scope;
+
+			schedule = !_pendingBytes;
+			_pending[type].append(utf8);
+			_pendingBytes += utf8.size();
+			overflow = (_pendingBytes >= kMaxPendingDebugBytes);
+		}
+
+		// The writer itself logs, when it fails to reopen a file.
+		if (overflow && !WritingPendingFlag) {
+			writePending();
+		} else if (schedule) {
+			_writer.async([=] { writePending(); });
+		}
+	}
+
 	void reopenDebug() {
 		time_t t = time(NULL);
 		struct tm tm;
@@ -424,6 +547,7 @@ void start() {
 }
 
 void finish() {
+	// The destructor writes all the pending debug entries.
 	delete LogsData;
 	LogsData = 0;
 
@@ -441,6 +565,12 @@ bool started() {
 	return LogsData != 0;
 }
 
+void writePendingAfterCrash() {
+	if (LogsData) {
+		LogsData->writePendingAfterCrash();
+	}
+}
+
 bool instanceChecked() {
 	if (!LogsData) return false;
 
@@ -21,6 +21,9 @@ void start();
 bool started();
 void finish();
 
+// Debug entries are written in batches, the crash handler writes the rest.
+void writePendingAfterCrash();
+
 bool instanceChecked();
 void multipleInstances();
 
@@ -179,6 +179,9 @@ ReaderImplementation::ReadResult FFMpegReaderImplementation::readFramesTill(crl:
 		return readResult;
 	}
 	readResult = readNextFrame();
+	if (readResult == ReadResult::Success) {
+		++_droppedFrames;
+	}
 	if (_frameTime <= frameMs) {
 		_frameTime = frameMs + 5; // keep up
 	}
@@ -57,6 +57,10 @@ public:
 	int64 dataSize() const {
 		return _dataSize;
 	}
+	// Frames skipped to keep up with the playback time.
+	int droppedFrames() const {
+		return _droppedFrames;
+	}
 
 protected:
 	Core::FileLocation *_location = nullptr;
@@ -65,6 +69,7 @@ protected:
 	QBuffer _buffer;
 	QIODevice *_device = nullptr;
 	int64 _dataSize = 0;
+	int _droppedFrames = 0;
 
 	void initDevice();
 
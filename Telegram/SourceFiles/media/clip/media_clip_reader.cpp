@@ -33,9 +33,18 @@ namespace Media {
 namespace Clip {
 namespace {
 
-constexpr auto kClipThreadsCount = 8;
+constexpr auto kClipThreadsCountMax = 8;
 constexpr auto kAverageGifSize = 320 * 240;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
+constexpr auto kLateFrameDelay = crl::time(20);
+
+[[nodiscard]] int ClipThreadsCount() {
+	static const auto result = std::clamp(
+		QThread::idealThreadCount(),
+		1,
+		kClipThreadsCountMax);
+	return result;
+}
 
 QImage PrepareFrame(
 		const FrameRequest &request,
@@ -203,7 +212,7 @@ Reader::Reader(const QByteArray &data, Callback &&callback)
 }
 
 void Reader::init(const Core::FileLocation &location, const QByteArray &data) {
-	if (Workers.size() < kClipThreadsCount) {
+	if (int(Workers.size()) < ClipThreadsCount()) {
 		_threadIndex = Workers.size();
 		Workers.push_back(std::make_unique<Worker>());
 	} else {
@@ -544,6 +553,9 @@ public:
 	}
 
 	ProcessResult finishProcess(crl::time ms) {
+		if (_nextFrameWhen && ms > _nextFrameWhen + kLateFrameDelay) {
+			++_lateFrames;
+		}
 		auto frameMs = _seekPositionMs + ms - _animationStarted;
 		auto readResult = _implementation->readFramesTill(frameMs, ms);
 		if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
@@ -629,6 +641,17 @@ public:
 	}
 
 	void stop() {
+		if (_implementation) {
+			const auto dropped = _implementation->droppedFrames();
+			if (dropped || _lateFrames) {
+				DEBUG_LOG(("Clip Info: %1x%2 reader dropped %3, late %4."
+					).arg(_width
+					).arg(_height
+					).arg(dropped
+					).arg(_lateFrames));
+			}
+			_lateFrames = 0;
+		}
 		_implementation = nullptr;
 		if (_location) {
 			if (_accessed) {
@@ -682,6 +705,7 @@ private:
 	crl::time _animationStarted = 0;
 	crl::time _nextFrameWhen = 0;
 	crl::time _nextFramePositionMs = 0;
+	int _lateFrames = 0;
 
 	bool _autoPausedGif = false;
 	bool _started = false;
@@ -894,26 +918,41 @@ void Manager::process() {
 		checkAllReaders = (_readers.size() > _readerPointers.size());
 	}
 
+	// Process the readers with the earliest frame deadlines first.
+	using DueReader = std::pair<crl::time, ReaderPrivate*>;
+	auto due = std::vector<DueReader>();
+	for (auto i = _readers.cbegin(), e = _readers.cend(); i != e; ++i) {
+		if (i.value() <= ms) {
+			due.emplace_back(i.value(), i.key());
+		}
+	}
+	ranges::sort(due);
+	const auto processed = [&](ReaderPrivate *reader) {
+		return ranges::contains(due, reader, &DueReader::second);
+	};
+	for (const auto &[when, reader] : due) {
+		ResultHandleState state = handleResult(reader, reader->process(ms), ms);
+		if (state == ResultHandleRemove) {
+			_readers.remove(reader);
+			continue;
+		} else if (state == ResultHandleStop) {
+			_processingInThread = nullptr;
+			return;
+		}
+		ms = crl::now();
+		auto &next = _readers[reader];
+		if (reader->_videoPausedAtMs) {
+			next = ms + 86400 * 1000ULL;
+		} else if (reader->_nextFrameWhen && reader->_started) {
+			next = reader->_nextFrameWhen;
+		} else {
+			next = (ms + 86400 * 1000ULL);
+		}
+	}
+
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
-		if (i.value() <= ms) {
-			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
-			if (state == ResultHandleRemove) {
-				i = _readers.erase(i);
-				continue;
-			} else if (state == ResultHandleStop) {
-				_processingInThread = nullptr;
-				return;
-			}
-			ms = crl::now();
-			if (reader->_videoPausedAtMs) {
-				i.value() = ms + 86400 * 1000ULL;
-			} else if (reader->_nextFrameWhen && reader->_started) {
-				i.value() = reader->_nextFrameWhen;
-			} else {
-				i.value() = (ms + 86400 * 1000ULL);
-			}
-		} else if (checkAllReaders) {
+		if (checkAllReaders && !processed(reader)) {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
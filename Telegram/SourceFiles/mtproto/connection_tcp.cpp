@@ -586,7 +586,7 @@ void TcpConnection::socketPacket(bytes::const_span bytes) {
 	Expects(_socket != nullptr);
 
 	// old quickack?..
-	const auto data = parsePacket(bytes);
+	auto data = parsePacket(bytes);
 	if (data.size() == 1) {
 		if (data[0] != 0) {
 			error(data[0]);
@@ -596,7 +596,7 @@ void TcpConnection::socketPacket(bytes::const_span bytes) {
 	//} else if (data.size() == 2) {
 		// new quickack?..
 	} else if (_status == Status::Ready) {
-		_receivedQueue.push_back(data);
+		_receivedQueue.push_back(std::move(data));
 		receivedData();
 	} else if (_status == Status::Waiting) {
 		if (const auto res_pq = readPQFakeReply(data)) {
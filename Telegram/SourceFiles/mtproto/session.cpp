@@ -434,10 +434,17 @@ void Session::sendPrepared(
 	}
 
 	DEBUG_LOG(("MTP Info: added, requestId %1").arg(request->requestId));
-	if (msCanWait >= 0) {
+	if (msCanWait > 0) {
 		InvokeQueued(this, [=] {
 			sendAnything(msCanWait);
 		});
+	} else if (!msCanWait && !_sendAnythingQueued.exchange(true)) {
+		// All the requests added till the queued call starts
+		// will be sent by the same tryToSend().
+		InvokeQueued(this, [=] {
+			_sendAnythingQueued = false;
+			sendAnything();
+		});
 	}
 }
 
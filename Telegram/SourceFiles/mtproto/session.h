@@ -14,6 +14,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QTimer>
 
+#include <atomic>
+
 namespace MTP {
 
 class Instance;
@@ -210,6 +212,9 @@ private:
 	crl::time _msSendCall = 0;
 	crl::time _msWait = 0;
 
+	// Requests sent without waiting in a burst share one sendAnything().
+	std::atomic<bool> _sendAnythingQueued = false;
+
 	bool _ping = false;
 
 	base::Timer _sender;
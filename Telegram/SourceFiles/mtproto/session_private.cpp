@@ -50,6 +50,9 @@ constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+// Keep the buffer for decrypting received messages up to this size.
+constexpr auto kKeepDecryptedBufferSize = 256 * 1024;
+
 // How much time passed from send till we resend request or check its state.
 constexpr auto kCheckSentRequestTimeout = 10 * crl::time(1000);
 
@@ -62,6 +65,9 @@ constexpr auto kAckSendWaiting = 10 * crl::time(1000);
 
 constexpr auto kCutContainerOnSize = 16 * 1024;
 
+// How often to write the sent packets and containers counters to log.
+constexpr auto kSendStatsLogTimeout = 60 * crl::time(1000);
+
 auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
@@ -700,6 +706,8 @@ void SessionPrivate::tryToSend() {
 
 	auto needAnyResponse = false;
 	auto someSkipped = false;
+	auto messagesInPacket = 1;
+	auto inContainer = false;
 	SerializedRequest toSendRequest;
 	{
 		QWriteLocker locker1(_sessionData->toSendMutex());
@@ -821,6 +829,9 @@ void SessionPrivate::tryToSend() {
 				}
 			}
 		} else { // send in container
+			messagesInPacket = totalSending;
+			inContainer = true;
+
 			bool willNeedInit = false;
 			uint32 containerSize = 1 + 1; // cons + vector size
 			if (pingRequest) containerSize += pingRequest.messageSize();
@@ -973,6 +984,10 @@ void SessionPrivate::tryToSend() {
 			}
 		}
 	}
+	countSentPacket(
+		inContainer,
+		messagesInPacket,
+		toSendRequest->size() * sizeof(mtpPrime));
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
 	if (someSkipped) {
 		InvokeQueued(this, [=] {
@@ -981,6 +996,40 @@ void SessionPrivate::tryToSend() {
 	}
 }
 
+void SessionPrivate::countSentPacket(
+		bool container,
+		int messages,
+		int bytes) {
+	const auto now = crl::now();
+	if (!_sendStats.since) {
+		_sendStats.since = now;
+	}
+	++_sendStats.packets;
+	_sendStats.messages += messages;
+	_sendStats.bytes += bytes;
+	if (container) {
+		++_sendStats.containers;
+		_sendStats.containerBytes += bytes;
+	}
+	const auto duration = now - _sendStats.since;
+	if (duration < kSendStatsLogTimeout) {
+		return;
+	}
+	const auto &stats = _sendStats;
+	DEBUG_LOG(("MTP Info: dc %1 sent %2 packets with %3 messages, "
+		"%4 bytes in %5 ms, containers: %6 per second, %7 bytes average."
+		).arg(_shiftedDcId
+		).arg(stats.packets
+		).arg(stats.messages
+		).arg(stats.bytes
+		).arg(duration
+		).arg(stats.containers * 1000. / duration, 0, 'f', 2
+		).arg(stats.containers
+			? (stats.containerBytes / stats.containers)
+			: 0));
+	_sendStats = SendStats{ .since = now };
+}
+
 void SessionPrivate::retryByTimer() {
 	if (_retryTimeout < 3) {
 		++_retryTimeout;
@@ -1263,6 +1312,11 @@ void SessionPrivate::handleReceived() {
 
 	onReceivedSome();
 
+	const auto guard = gsl::finally([&] {
+		if (_decryptedBuffer.size() > kKeepDecryptedBufferSize) {
+			_decryptedBuffer = QByteArray();
+		}
+	});
 	while (!_connection->received().empty()) {
 		auto intsBuffer = std::move(_connection->received().front());
 		_connection->received().pop_front();
@@ -1288,12 +1342,14 @@ void SessionPrivate::handleReceived() {
 		auto encryptedInts = ints + kExternalHeaderIntsCount;
 		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
 		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
+		if (_decryptedBuffer.size() < int(encryptedBytesCount)) {
+			_decryptedBuffer.resize(encryptedBytesCount);
+		}
 		auto msgKey = *(MTPint128*)(ints + 2);
 
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
+		aesIgeDecrypt(encryptedInts, _decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
 
-		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+		auto decryptedInts = reinterpret_cast<const mtpPrime*>(_decryptedBuffer.constData());
 		auto serverSalt = *(uint64*)&decryptedInts[0];
 		auto session = *(uint64*)&decryptedInts[2];
 		auto msgId = *(uint64*)&decryptedInts[4];
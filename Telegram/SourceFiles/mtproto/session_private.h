@@ -61,6 +61,14 @@ private:
 		crl::time sent = 0;
 		std::vector<mtpMsgId> messages;
 	};
+	struct SendStats {
+		crl::time since = 0;
+		int packets = 0;
+		int containers = 0;
+		int messages = 0;
+		int64 bytes = 0;
+		int64 containerBytes = 0;
+	};
 	enum class HandleResult {
 		Success,
 		Ignored,
@@ -114,6 +122,7 @@ private:
 		SerializedRequest &request,
 		mtpMsgId newId);
 
+	void countSentPacket(bool container, int messages, int bytes);
 	bool sendSecureRequest(
 		SerializedRequest &&request,
 		bool needAnyResponse);
@@ -225,6 +234,9 @@ private:
 	uint32 _messagesCounter = 0;
 	bool _sessionMarkedAsStarted = false;
 
+	// Reused for decrypting received messages, see handleReceived().
+	QByteArray _decryptedBuffer;
+
 	QVector<MTPlong> _ackRequestData;
 	QVector<MTPlong> _resendRequestData;
 	base::flat_set<mtpMsgId> _stateRequestData;
@@ -233,6 +245,7 @@ private:
 	base::flat_map<mtpMsgId, mtpRequestId> _ackedIds;
 	base::flat_map<mtpMsgId, SerializedRequest> _stateAndResendRequests;
 	base::flat_map<mtpMsgId, SentContainer> _sentContainers;
+	SendStats _sendStats;
 
 	std::unique_ptr<BoundKeyCreator> _keyCreator;
 	mtpMsgId _bindMsgId = 0;
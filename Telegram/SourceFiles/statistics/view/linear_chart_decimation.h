@@ -0,0 +1,85 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <array>
+#include <cmath>
+
+namespace Statistic {
+
+// With many points per pixel column keeps only the first, the top,
+// the bottom and the last point of each column, in their original order.
+// The polyline looks the same, but stroking it doesn't depend on the
+// points count.
+template <typename Points>
+class LinearChartDecimation final {
+public:
+	using Point = typename Points::value_type;
+
+	explicit LinearChartDecimation(Points &points) : _points(points) {
+	}
+
+	void add(const Point &point) {
+		const auto x = int(std::floor(point.x()));
+		if (_column.count && _column.x != x) {
+			finish();
+		}
+		if (!_column.count) {
+			_column.x = x;
+			_column.first = _column.top = _column.bottom = point;
+			_column.topIndex = _column.bottomIndex = 0;
+		} else if (point.y() < _column.top.y()) {
+			_column.top = point;
+			_column.topIndex = _column.count;
+		} else if (point.y() > _column.bottom.y()) {
+			_column.bottom = point;
+			_column.bottomIndex = _column.count;
+		}
+		_column.last = point;
+		++_column.count;
+	}
+
+	void finish() {
+		if (!_column.count) {
+			return;
+		}
+		_points.push_back(_column.first);
+		const auto topFirst = (_column.topIndex < _column.bottomIndex);
+		const auto middle = std::array{
+			topFirst ? _column.top : _column.bottom,
+			topFirst ? _column.bottom : _column.top,
+		};
+		for (const auto &point : middle) {
+			if (point != _column.first && point != _column.last) {
+				_points.push_back(point);
+			}
+		}
+		if (_column.count > 1) {
+			_points.push_back(_column.last);
+		}
+		_column = Column();
+	}
+
+private:
+	struct Column {
+		Point first;
+		Point top;
+		Point bottom;
+		Point last;
+		int topIndex = 0;
+		int bottomIndex = 0;
+		int x = 0;
+		int count = 0;
+	};
+
+	Points &_points;
+	Column _column;
+
+};
+
+} // namespace Statistic
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_statistics_chart.h"
 #include "statistics/chart_lines_filter_controller.h"
 #include "statistics/statistics_common.h"
+#include "statistics/view/linear_chart_decimation.h"
 #include "ui/effects/animation_value_f.h"
 #include "ui/painter.h"
 #include "styles/style_boxes.h"
@@ -18,6 +19,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Statistic {
 namespace {
 
+constexpr auto kDecimateFromPointsPerPixel = 2;
+
 void PaintChartLine(
 		QPainter &p,
 		int lineIndex,
@@ -35,6 +38,12 @@ void PaintChartLine(
 
 	const auto ratio = ratios.ratio(line.id);
 
+	const auto decimate = (localEnd - localStart)
+		> kDecimateFromPointsPerPixel * c.rect.width();
+	auto decimation = LinearChartDecimation<QPolygonF>(chartPoints);
+	if (decimate) {
+		chartPoints.reserve(4 * (c.rect.width() + 1));
+	}
 	for (auto i = localStart; i <= localEnd; i++) {
 		if (line.y[i] < 0) {
 			continue;
@@ -45,8 +54,14 @@ void PaintChartLine(
 		const auto yPercentage = (line.y[i] * ratio - c.heightLimits.min)
 			/ float64(c.heightLimits.max - c.heightLimits.min);
 		const auto yPoint = (1. - yPercentage) * c.rect.height();
-		chartPoints << QPointF(xPoint, yPoint);
+		const auto point = QPointF(xPoint, yPoint);
+		if (decimate) {
+			decimation.add(point);
+		} else {
+			chartPoints << point;
+		}
 	}
+	decimation.finish();
 	p.setPen(QPen(
 		line.color,
 		c.footer ? st::lineWidth : st::statisticsChartLineWidth));
@@ -0,0 +1,93 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/details/storage_download_balance.h"
+
+namespace Storage::details {
+namespace {
+
+constexpr auto kMinRttExpiresTimeout = 10 * crl::time(1000);
+constexpr auto kQueueingRttFactor = 2;
+constexpr auto kBandwidthDelayProductGain = 2;
+
+static_assert(!(kMaxDownloadPartSize % kDownloadPartSize));
+
+} // namespace
+
+DownloadSessionBalance::DownloadSessionBalance()
+: maxWaitedAmount(kStartWaitedInSession) {
+}
+
+void DownloadSessionBalance::feedSample(
+		crl::time now,
+		crl::time duration,
+		int amount) {
+	duration = std::max(duration, crl::time(1));
+	if (!minRtt
+		|| duration <= minRtt
+		|| now - minRttUpdated >= kMinRttExpiresTimeout) {
+		minRtt = duration;
+		minRttUpdated = now;
+	}
+	smoothedRtt = smoothedRtt
+		? ((7 * smoothedRtt + duration) / 8)
+		: duration;
+	const auto rate = int64(amount) * 1000 / duration;
+	bandwidth = bandwidth ? ((3 * bandwidth + rate) / 4) : rate;
+}
+
+bool DownloadSessionBalance::updateWaitedAmount(
+		int amountAtRequestStart,
+		int partSize) {
+	if (queueing()) {
+		const auto target = kBandwidthDelayProductGain
+			* bandwidthDelayProduct();
+		const auto limited = std::max(
+			(target / kDownloadPartSize) * kDownloadPartSize,
+			kStartWaitedInSession);
+		if (limited < maxWaitedAmount) {
+			maxWaitedAmount = limited;
+			return true;
+		}
+	} else if (amountAtRequestStart + partSize > maxWaitedAmount
+		&& maxWaitedAmount < kMaxWaitedInSession) {
+		maxWaitedAmount = std::min(
+			maxWaitedAmount + partSize,
+			kMaxWaitedInSession);
+		return true;
+	}
+	return false;
+}
+
+bool DownloadSessionBalance::fits(int partSize) const {
+	// A single part is always allowed, even if it is larger
+	// than the amount we're ready to wait for in that session.
+	return (requests < kMaxRequestsInSession)
+		&& (!requested || (requested + partSize <= maxWaitedAmount));
+}
+
+bool DownloadSessionBalance::limited(int partSize) const {
+	return (maxWaitedAmount >= MaxWaitedInSession(partSize)) || queueing();
+}
+
+int DownloadSessionBalance::bandwidthDelayProduct() const {
+	const auto result = bandwidth * minRtt / 1000;
+	return int(std::clamp(
+		result,
+		int64(kDownloadPartSize),
+		int64(kMaxWaitedInSession)));
+}
+
+bool DownloadSessionBalance::queueing() const {
+	return minRtt && (smoothedRtt > kQueueingRttFactor * minRtt);
+}
+
+int MaxWaitedInSession(int partSize) {
+	return std::min(kMaxWaitedInSession, kMaxRequestsInSession * partSize);
+}
+
+} // namespace Storage::details
@@ -0,0 +1,60 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+
+#include <crl/crl_time.h>
+
+namespace Storage {
+
+// Minimal part size, all the loaders that need fixed size parts use it.
+// Each task chooses its own part size before the first request is sent,
+// CDN hashes are checked by kDownloadPartSize chunks inside larger parts.
+constexpr auto kDownloadPartSize = 128 * 1024;
+constexpr auto kMaxDownloadPartSize = 1024 * 1024;
+
+namespace details {
+
+constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
+constexpr auto kMaxWaitedInSession = 4 * kMaxDownloadPartSize;
+constexpr auto kMaxRequestsInSession = 16;
+
+// Congestion control, per session we track the shortest request duration
+// and the delivery rate (amount in flight divided by request duration).
+// The amount we're ready to wait for grows while requests don't queue
+// and shrinks to twice the bandwidth-delay product when they start to.
+struct DownloadSessionBalance {
+	DownloadSessionBalance();
+
+	void feedSample(crl::time now, crl::time duration, int amount);
+
+	// Returns true if maxWaitedAmount was changed.
+	bool updateWaitedAmount(int amountAtRequestStart, int partSize);
+
+	[[nodiscard]] bool fits(int partSize) const;
+	[[nodiscard]] bool limited(int partSize) const;
+	[[nodiscard]] int bandwidthDelayProduct() const;
+	[[nodiscard]] bool queueing() const;
+
+	int requested = 0;
+	int requests = 0;
+	int successes = 0; // Since last timeout in this dc in any session.
+	int maxWaitedAmount = 0;
+
+	crl::time minRtt = 0;
+	crl::time minRttUpdated = 0;
+	crl::time smoothedRtt = 0;
+	int64 bandwidth = 0; // Bytes per second.
+};
+
+// The most we may wait for in one session with parts of that size.
+[[nodiscard]] int MaxWaitedInSession(int partSize);
+
+} // namespace details
+} // namespace Storage
@@ -0,0 +1,216 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+#include "base/assertion.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace Storage::details {
+
+// Task should provide readyToRequest(), partSize() and removeSession(int).
+//
+// Tasks are kept in a separate list for each part size, so the first task
+// that fits the sessions is found by looking only at the list heads.
+// A task found not ready to request is parked until unpark() is called
+// for it, the owner must call it when the task may become ready again.
+template <typename Task>
+class DownloadQueue final {
+public:
+	void enqueue(not_null<Task*> task, int priority);
+	void remove(not_null<Task*> task);
+	void unpark(not_null<Task*> task);
+	void resetGeneration();
+	[[nodiscard]] bool empty() const;
+	[[nodiscard]] int size() const;
+	void removeSession(int index);
+
+	// Fits is called as fits(not_null<Task*>) and its result may depend
+	// only on the part size of the task.
+	template <typename Fits>
+	[[nodiscard]] Task *nextTask(bool onlyHighestPriority, Fits &&fits);
+
+	// Tasks in the order they are requested.
+	template <typename Callback>
+	void enumerate(Callback &&callback) const;
+
+private:
+	// Higher priority first, inside one priority last enqueued first.
+	struct Key {
+		int priority = 0;
+		uint64 generation = 0;
+
+		friend inline bool operator<(const Key &a, const Key &b) {
+			return (a.priority > b.priority)
+				|| (a.priority == b.priority
+					&& a.generation > b.generation);
+		}
+	};
+	using Tasks = std::map<Key, not_null<Task*>>;
+	struct Position {
+		typename Tasks::iterator i;
+		bool parked = false;
+	};
+
+	void insert(Key key, not_null<Task*> task, bool parked);
+	void resetGeneration(Tasks &tasks, bool parked);
+	[[nodiscard]] Tasks &list(not_null<Task*> task, bool parked);
+
+	// Part size of a task doesn't change while it is enqueued.
+	std::map<int, Tasks> _ready;
+	Tasks _parked;
+	std::unordered_map<not_null<Task*>, Position> _index;
+	std::vector<typename Tasks::iterator> _heads;
+	uint64 _generation = 0;
+
+};
+
+template <typename Task>
+void DownloadQueue<Task>::enqueue(not_null<Task*> task, int priority) {
+	remove(task);
+	insert({ priority, ++_generation }, task, false);
+}
+
+template <typename Task>
+auto DownloadQueue<Task>::list(not_null<Task*> task, bool parked)
+-> Tasks & {
+	return parked ? _parked : _ready[task->partSize()];
+}
+
+template <typename Task>
+void DownloadQueue<Task>::insert(Key key, not_null<Task*> task, bool parked) {
+	const auto [i, ok] = list(task, parked).emplace(key, task);
+	Assert(ok);
+	_index.insert_or_assign(task, Position{ i, parked });
+}
+
+template <typename Task>
+void DownloadQueue<Task>::remove(not_null<Task*> task) {
+	const auto i = _index.find(task);
+	if (i != end(_index)) {
+		list(task, i->second.parked).erase(i->second.i);
+		_index.erase(i);
+	}
+}
+
+template <typename Task>
+void DownloadQueue<Task>::unpark(not_null<Task*> task) {
+	const auto i = _index.find(task);
+	if (i != end(_index) && i->second.parked) {
+		const auto key = i->second.i->first;
+		_parked.erase(i->second.i);
+		insert(key, task, false);
+	}
+}
+
+template <typename Task>
+void DownloadQueue<Task>::resetGeneration() {
+	for (auto &[partSize, tasks] : _ready) {
+		resetGeneration(tasks, false);
+	}
+	resetGeneration(_parked, true);
+}
+
+template <typename Task>
+void DownloadQueue<Task>::resetGeneration(Tasks &tasks, bool parked) {
+	// All the tasks with zero priority were enqueued after the last reset,
+	// so they stay before the already reset ones, keeping their order.
+	const auto first = Key{ 0, std::numeric_limits<uint64>::max() };
+	auto i = tasks.lower_bound(first);
+	while (i != end(tasks) && !i->first.priority) {
+		const auto key = Key{ -1, i->first.generation };
+		const auto task = i->second;
+		i = tasks.erase(i);
+		insert(key, task, parked);
+	}
+}
+
+template <typename Task>
+bool DownloadQueue<Task>::empty() const {
+	return _index.empty();
+}
+
+template <typename Task>
+int DownloadQueue<Task>::size() const {
+	return int(_index.size());
+}
+
+template <typename Task>
+template <typename Fits>
+Task *DownloadQueue<Task>::nextTask(bool onlyHighestPriority, Fits &&fits) {
+	if (_index.empty()) {
+		return nullptr;
+	}
+	_heads.clear();
+	for (auto &[partSize, tasks] : _ready) {
+		for (auto i = begin(tasks); i != end(tasks); i = begin(tasks)) {
+			if (i->second->readyToRequest()) {
+				_heads.push_back(i);
+				break;
+			}
+			const auto key = i->first;
+			const auto task = i->second;
+			tasks.erase(i);
+			insert(key, task, true);
+		}
+	}
+	if (_heads.empty()) {
+		return nullptr;
+	}
+	const auto byKey = [](
+			typename Tasks::iterator a,
+			typename Tasks::iterator b) {
+		return a->first < b->first;
+	};
+	std::sort(begin(_heads), end(_heads), byKey);
+	const auto highestPriority = _parked.empty()
+		? _heads.front()->first.priority
+		: std::max(
+			_heads.front()->first.priority,
+			begin(_parked)->first.priority);
+	for (const auto i : _heads) {
+		if (onlyHighestPriority
+			&& highestPriority > 0
+			&& i->first.priority != highestPriority) {
+			break;
+		} else if (fits(i->second)) {
+			return i->second;
+		}
+	}
+	return nullptr;
+}
+
+template <typename Task>
+void DownloadQueue<Task>::removeSession(int index) {
+	for (const auto &[task, position] : _index) {
+		task->removeSession(index);
+	}
+}
+
+template <typename Task>
+template <typename Callback>
+void DownloadQueue<Task>::enumerate(Callback &&callback) const {
+	auto all = std::vector<std::pair<Key, not_null<Task*>>>();
+	all.reserve(_index.size());
+	for (const auto &[task, position] : _index) {
+		all.emplace_back(position.i->first, task);
+	}
+	std::sort(begin(all), end(all), [](const auto &a, const auto &b) {
+		return a.first < b.first;
+	});
+	for (const auto &[key, task] : all) {
+		callback(task);
+	}
+}
+
+} // namespace Storage::details
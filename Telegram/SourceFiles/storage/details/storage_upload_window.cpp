@@ -0,0 +1,34 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/details/storage_upload_window.h"
+
+namespace Storage::details {
+
+bool UploadSessionWindow::full(int alreadySent, int64 bytes) const {
+	return alreadySent && (alreadySent + bytes > size);
+}
+
+void UploadSessionWindow::requestDone(
+		crl::time sent,
+		crl::time received,
+		int bytes,
+		bool fast) {
+	if (!fast) {
+		// Halve only once for all the requests sent before the decrease.
+		if (sent > decreased) {
+			size = std::max(size / 2, kMinUploadPerSession);
+			decreased = received;
+		}
+	} else if (size < kMaxUploadPerSession) {
+		// About one part per the whole window of fast requests.
+		const auto add = std::max(int(int64(bytes) * bytes / size), 1);
+		size = std::min(size + add, kMaxUploadPerSession);
+	}
+}
+
+} // namespace Storage::details
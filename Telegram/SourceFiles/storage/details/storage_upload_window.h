@@ -0,0 +1,37 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+
+#include <crl/crl_time.h>
+
+namespace Storage::details {
+
+// The amount uploaded at the same time in each session is adjusted
+// between these limits, starting at 1mb: grown while requests are fast
+// and halved when a request is slow, much like a TCP congestion window.
+constexpr auto kMinUploadPerSession = 256 * 1024;
+constexpr auto kStartUploadPerSession = 1024 * 1024;
+constexpr auto kMaxUploadPerSession = 2 * 1024 * 1024;
+
+struct UploadSessionWindow {
+	// Always allows at least one request, even if parts are big.
+	[[nodiscard]] bool full(int alreadySent, int64 bytes) const;
+
+	void requestDone(
+		crl::time sent,
+		crl::time received,
+		int bytes,
+		bool fast);
+
+	int size = kStartUploadPerSession;
+	crl::time decreased = 0;
+};
+
+} // namespace Storage::details
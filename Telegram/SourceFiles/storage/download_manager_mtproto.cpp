@@ -19,9 +19,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Storage {
 namespace {
 
+using namespace details;
+
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
-constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
-constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
 constexpr auto kMaxTrackedSessionRemoves = 64;
@@ -33,90 +33,42 @@ constexpr auto kRemoveSessionAfterTimeouts = 4;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
 
+// After a session is added we check that the dc bandwidth has grown,
+// otherwise the session is removed as if it has timed out.
+constexpr auto kAddedSessionCheckTimeout = 4 * crl::time(1000);
+constexpr auto kAddedSessionMinGainPercent = 110;
+
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
 // and for successes in all remaining sessions:
 // kRetryAddSessionSuccesses * max(removesCount, kMaxTrackedSessionRemoves)
 
-} // namespace
-
-void DownloadManagerMtproto::Queue::enqueue(
-		not_null<Task*> task,
-		int priority) {
-	const auto position = ranges::find_if(_tasks, [&](const Enqueued &task) {
-		return task.priority <= priority;
-	}) - begin(_tasks);
-	const auto now = ranges::find(_tasks, task, &Enqueued::task);
-	const auto i = [&] {
-		if (now != end(_tasks)) {
-			(now->priority = priority);
-			return now;
-		}
-		_tasks.push_back({ task, priority });
-		return end(_tasks) - 1;
-	}();
-	const auto j = begin(_tasks) + position;
-	if (j < i) {
-		std::rotate(j, i, i + 1);
-	} else if (j > i + 1) {
-		std::rotate(i, i + 1, j);
-	}
-}
-
-void DownloadManagerMtproto::Queue::remove(not_null<Task*> task) {
-	_tasks.erase(ranges::remove(_tasks, task, &Enqueued::task), end(_tasks));
-}
-
-void DownloadManagerMtproto::Queue::resetGeneration() {
-	const auto from = ranges::find(_tasks, 0, &Enqueued::priority);
-	for (auto &task : ranges::make_subrange(from, end(_tasks))) {
-		if (task.priority) {
-			Assert(task.priority == -1);
-			break;
-		}
-		task.priority = -1;
-	}
-}
+// Part size must divide 1 MB, so that no part crosses a 1 MB boundary.
+constexpr auto kMediumPartSizeFrom = int64(8 * 1024 * 1024);
+constexpr auto kLargePartSizeFrom = int64(64 * 1024 * 1024);
 
-bool DownloadManagerMtproto::Queue::empty() const {
-	return _tasks.empty();
-}
-
-auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
--> Task* {
-	if (_tasks.empty()) {
-		return nullptr;
-	}
-	const auto highestPriority = _tasks.front().priority;
-	const auto notHighestPriority = [&](const Enqueued &enqueued) {
-		return (enqueued.priority != highestPriority);
-	};
-	const auto till = (onlyHighestPriority && highestPriority > 0)
-		? ranges::find_if(_tasks, notHighestPriority)
-		: end(_tasks);
-	const auto readyToRequest = [&](const Enqueued &enqueued) {
-		return enqueued.task->readyToRequest();
-	};
-	const auto first = ranges::find_if(
-		ranges::make_subrange(begin(_tasks), till),
-		readyToRequest);
-	return (first != till) ? first->task.get() : nullptr;
-}
-
-void DownloadManagerMtproto::Queue::removeSession(int index) {
-	for (const auto &enqueued : _tasks) {
-		enqueued.task->removeSession(index);
-	}
-}
+} // namespace
 
-DownloadManagerMtproto::DcSessionBalanceData::DcSessionBalanceData()
-: maxWaitedAmount(kStartWaitedInSession) {
+int ChooseDownloadPartSize(int64 fullSize) {
+	return (fullSize >= kLargePartSizeFrom)
+		? kMaxDownloadPartSize
+		: (fullSize >= kMediumPartSizeFrom)
+		? (kMaxDownloadPartSize / 2)
+		: kDownloadPartSize;
 }
 
 DownloadManagerMtproto::DcBalanceData::DcBalanceData()
 : sessions(kStartSessionsCount) {
 }
 
+int64 DownloadManagerMtproto::DcBalanceData::bandwidth() const {
+	return ranges::accumulate(
+		sessions,
+		int64(0),
+		ranges::plus(),
+		&DcSessionBalanceData::bandwidth);
+}
+
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
 : _api(api)
 , _resetGenerationTimer([=] { resetGeneration(); })
@@ -152,6 +104,13 @@ void DownloadManagerMtproto::remove(not_null<Task*> task) {
 	checkSendNext(dcId, queue);
 }
 
+void DownloadManagerMtproto::mayBeReadyToRequest(not_null<Task*> task) {
+	const auto i = _queues.find(task->dcId());
+	if (i != end(_queues)) {
+		i->second.unpark(task);
+	}
+}
+
 void DownloadManagerMtproto::resetGeneration() {
 	_resetGenerationTimer.cancel();
 	for (auto &[dcId, queue] : _queues) {
@@ -180,26 +139,32 @@ void DownloadManagerMtproto::checkSendNextAfterSuccess(MTP::DcId dcId) {
 bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 	auto &balanceData = _balanceData[dcId];
 	const auto &sessions = balanceData.sessions;
-	const auto bestIndex = [&] {
-		const auto proj = [](const DcSessionBalanceData &data) {
-			return (data.requested < data.maxWaitedAmount)
+	const auto bestIndex = [&](int partSize) {
+		const auto proj = [&](const DcSessionBalanceData &data) {
+			return data.fits(partSize)
 				? data.requested
-				: kMaxWaitedInSession;
+				: std::numeric_limits<int>::max();
 		};
 		const auto j = ranges::min_element(sessions, ranges::less(), proj);
-		return (j->requested + kDownloadPartSize <= j->maxWaitedAmount)
-			? (j - begin(sessions))
-			: -1;
-	}();
-	if (bestIndex < 0) {
+		return j->fits(partSize) ? int(j - begin(sessions)) : -1;
+	};
+	if (bestIndex(kDownloadPartSize) < 0) {
 		return false;
 	}
+	// Tasks with larger parts that don't fit the sessions right now
+	// shouldn't block the smaller parts of the tasks after them.
 	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
-	if (const auto task = queue.nextTask(onlyHighestPriority)) {
-		task->loadPart(bestIndex);
-		return true;
+	auto index = -1;
+	const auto fits = [&](not_null<Task*> candidate) {
+		index = bestIndex(candidate->partSize());
+		return (index >= 0);
+	};
+	const auto task = queue.nextTask(onlyHighestPriority, fits);
+	if (!task) {
+		return false;
 	}
-	return false;
+	task->loadPart(index);
+	return true;
 }
 
 int DownloadManagerMtproto::changeRequestedAmount(
@@ -209,8 +174,23 @@ int DownloadManagerMtproto::changeRequestedAmount(
 	const auto i = _balanceData.find(dcId);
 	Assert(i != _balanceData.end());
 	Assert(index < i->second.sessions.size());
-	const auto result = (i->second.sessions[index].requested += delta);
+	auto &session = i->second.sessions[index];
+	const auto result = (session.requested += delta);
+	session.requests += (delta > 0) ? 1 : -1;
 	i->second.totalRequested += delta;
+
+	const auto wasTotalRequested = _totalRequested;
+	_totalRequested += delta;
+	if (!wasTotalRequested && _totalRequested > 0) {
+		_activeSince = crl::now();
+	} else if (wasTotalRequested > 0 && !_totalRequested) {
+		_throughput.duration += crl::now() - _activeSince;
+		_activeSince = 0;
+		DEBUG_LOG(("Download throughput: %1 bytes/sec, %2 bytes in %3 ms."
+			).arg(_throughput.bytesPerSecond()
+			).arg(_throughput.bytes
+			).arg(_throughput.duration));
+	}
 	const auto findNonEmptySession = [](const DcBalanceData &data) {
 		using namespace rpl::mappers;
 		return ranges::find_if(
@@ -229,6 +209,7 @@ int DownloadManagerMtproto::changeRequestedAmount(
 void DownloadManagerMtproto::requestSucceeded(
 		MTP::DcId dcId,
 		int index,
+		int partSize,
 		int amountAtRequestStart,
 		crl::time timeAtRequestStart) {
 	using namespace rpl::mappers;
@@ -239,14 +220,20 @@ void DownloadManagerMtproto::requestSucceeded(
 	Assert(index < dc.sessions.size());
 	auto &data = dc.sessions[index];
 	const auto overloaded = (timeAtRequestStart <= dc.lastSessionRemove)
-		|| (amountAtRequestStart > data.maxWaitedAmount);
+		|| (amountAtRequestStart > std::max(data.maxWaitedAmount, partSize));
 	const auto parts = amountAtRequestStart / kDownloadPartSize;
-	const auto duration = (crl::now() - timeAtRequestStart);
-	DEBUG_LOG(("Download (%1,%2) request done, duration: %3, parts: %4%5"
+	const auto now = crl::now();
+	const auto duration = (now - timeAtRequestStart);
+	data.feedSample(now, duration, amountAtRequestStart);
+	DEBUG_LOG(("Download (%1,%2) request done, duration: %3, parts: %4, "
+		"rtt: %5 (min %6), bandwidth: %7%8"
 		).arg(dcId
 		).arg(index
 		).arg(duration
 		).arg(parts
+		).arg(data.smoothedRtt
+		).arg(data.minRtt
+		).arg(data.bandwidth
 		).arg(overloaded ? " (overloaded)" : ""));
 	if (overloaded) {
 		return;
@@ -259,16 +246,31 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
-	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
-		data.maxWaitedAmount = std::min(
-			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
-		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
+	if (data.updateWaitedAmount(amountAtRequestStart, partSize)) {
+		DEBUG_LOG(("Download (%1,%2) %3, max waited amount %4."
 			).arg(dcId
 			).arg(index
+			).arg(data.queueing() ? "queueing" : "increased"
 			).arg(data.maxWaitedAmount));
 	}
+	if (dc.lastSessionAdd
+		&& now >= dc.lastSessionAdd + kAddedSessionCheckTimeout) {
+		const auto added = int(dc.sessions.size() - 1);
+		const auto was = base::take(dc.bandwidthBeforeAdd);
+		const auto bandwidth = dc.bandwidth();
+		dc.lastSessionAdd = 0;
+		if (bandwidth * 100 < was * kAddedSessionMinGainPercent) {
+			DEBUG_LOG(("Download (%1,%2) didn't help: %3 -> %4."
+				).arg(dcId
+				).arg(added
+				).arg(was
+				).arg(bandwidth));
+			crl::on_main(this, [=] {
+				removeAddedSession(dcId, added);
+			});
+			return;
+		}
+	}
 	data.successes = std::min(data.successes + 1, kMaxTrackedSuccesses);
 	const auto notEnough = ranges::any_of(
 		dc.sessions,
@@ -286,11 +288,19 @@ void DownloadManagerMtproto::requestSucceeded(
 	} else if (dc.sessions.size() == kMaxSessionsCount) {
 		return;
 	}
-	const auto now = crl::now();
 	const auto delay = (dc.sessionRemoveTimes + 1) * kRetryAddSessionTimeout;
 	if (dc.lastSessionRemove && now < dc.lastSessionRemove + delay) {
 		return;
 	}
+	const auto limited = [&](const DcSessionBalanceData &session) {
+		return session.limited(partSize);
+	};
+	if (!ranges::all_of(dc.sessions, limited)) {
+		// There is room to grow in the existing sessions.
+		return;
+	}
+	dc.bandwidthBeforeAdd = dc.bandwidth();
+	dc.lastSessionAdd = now;
 	dc.sessions.emplace_back();
 	DEBUG_LOG(("Download (%1,%2) adding, now sessions: %3"
 		).arg(dcId
@@ -298,6 +308,18 @@ void DownloadManagerMtproto::requestSucceeded(
 		).arg(dc.sessions.size()));
 }
 
+void DownloadManagerMtproto::partReceived(int bytes) {
+	_throughput.bytes += bytes;
+}
+
+auto DownloadManagerMtproto::throughput() const -> Throughput {
+	auto result = _throughput;
+	if (_activeSince) {
+		result.duration += crl::now() - _activeSince;
+	}
+	return result;
+}
+
 int DownloadManagerMtproto::chooseSessionIndex(MTP::DcId dcId) const {
 	const auto i = _balanceData.find(dcId);
 	Assert(i != end(_balanceData));
@@ -330,6 +352,16 @@ void DownloadManagerMtproto::sessionTimedOut(MTP::DcId dcId, int index) {
 	removeSession(dcId);
 }
 
+void DownloadManagerMtproto::removeAddedSession(MTP::DcId dcId, int index) {
+	const auto i = _balanceData.find(dcId);
+	if (i == end(_balanceData)
+		|| i->second.sessions.size() != index + 1
+		|| i->second.sessions.size() == kStartSessionsCount) {
+		return;
+	}
+	removeSession(dcId);
+}
+
 void DownloadManagerMtproto::removeSession(MTP::DcId dcId) {
 	auto &dc = _balanceData[dcId];
 	Assert(dc.sessions.size() > kStartSessionsCount);
@@ -358,6 +390,8 @@ void DownloadManagerMtproto::removeSession(MTP::DcId dcId) {
 	api().instance().killSession(MTP::downloadDcId(dcId, index));
 
 	dc.lastSessionRemove = crl::now();
+	dc.lastSessionAdd = 0;
+	dc.bandwidthBeforeAdd = 0;
 }
 
 void DownloadManagerMtproto::killSessionsSchedule(MTP::DcId dcId) {
@@ -454,6 +488,19 @@ const DownloadMtprotoTask::Location &DownloadMtprotoTask::location() const {
 	return _location;
 }
 
+int DownloadMtprotoTask::partSize() const {
+	return _partSize;
+}
+
+void DownloadMtprotoTask::setPartSize(int size) {
+	Expects(size >= kDownloadPartSize && size <= kMaxDownloadPartSize);
+	Expects(!(size % kDownloadPartSize));
+	Expects(!(kMaxDownloadPartSize % size));
+	Expects(_sentRequests.empty());
+
+	_partSize = size;
+}
+
 void DownloadMtprotoTask::refreshFileReferenceFrom(
 		const Data::UpdatedFileReferences &updates,
 		int requestId,
@@ -512,7 +559,7 @@ void DownloadMtprotoTask::removeSession(int sessionIndex) {
 mtpRequestId DownloadMtprotoTask::sendRequest(
 		const RequestData &requestData) {
 	const auto offset = requestData.offset;
-	const auto limit = Storage::kDownloadPartSize;
+	const auto limit = _partSize;
 	const auto shiftedDcId = MTP::downloadDcId(
 		_cdnDcId ? _cdnDcId : dcId(),
 		requestData.sessionIndex);
@@ -603,13 +650,17 @@ void DownloadMtprotoTask::requestMoreCdnFileHashes() {
 		return;
 	}
 
-	const auto requestData = _cdnUncheckedParts.cbegin()->first;
+	const auto &[requestData, unchecked] = *_cdnUncheckedParts.cbegin();
+	const auto missing = firstMissingCdnFileHash(
+		requestData.offset,
+		unchecked.size());
+	const auto offset = (missing >= 0) ? missing : requestData.offset;
 	const auto shiftedDcId = MTP::downloadDcId(
 		dcId(),
 		requestData.sessionIndex);
 	_cdnHashesRequestId = api().request(MTPupload_GetCdnFileHashes(
 		MTP_bytes(_cdnToken),
-		MTP_long(requestData.offset)
+		MTP_long(offset)
 	)).done([=](const MTPVector<MTPFileHash> &result, mtpRequestId id) {
 		getCdnFileHashesDone(result, id);
 	}).fail([=](const MTP::Error &error, mtpRequestId id) {
@@ -629,6 +680,7 @@ void DownloadMtprotoTask::normalPartLoaded(
 	result.match([&](const MTPDupload_fileCdnRedirect &data) {
 		switchToCDN(requestData, data);
 	}, [&](const MTPDupload_file &data) {
+		_owner->partReceived(data.vbytes().v.size());
 		partLoaded(requestData.offset, data.vbytes().v);
 	});
 
@@ -645,6 +697,7 @@ void DownloadMtprotoTask::webPartLoaded(
 	const auto owner = _owner;
 	const auto dcId = this->dcId();
 	result.match([&](const MTPDupload_webFile &data) {
+		_owner->partReceived(data.vbytes().v.size());
 		if (setWebFileSizeHook(data.vsize().v)) {
 			partLoaded(requestData.offset, data.vbytes().v);
 		}
@@ -698,6 +751,7 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 		state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
 
 		auto decryptInPlace = data.vbytes().v;
+		owner->partReceived(decryptInPlace.size());
 		auto buffer = bytes::make_detached_span(decryptInPlace);
 		MTP::aesCtrEncrypt(buffer, key.data(), &state);
 
@@ -724,18 +778,39 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 DownloadMtprotoTask::CheckCdnHashResult DownloadMtprotoTask::checkCdnFileHash(
 		int64 offset,
 		bytes::const_span buffer) {
-	const auto cdnFileHashIt = _cdnFileHashes.find(offset);
-	if (cdnFileHashIt == _cdnFileHashes.cend()) {
+	// Hashes are provided by (usually kDownloadPartSize) chunks,
+	// so a larger part is checked by all the chunks it consists of.
+	if (firstMissingCdnFileHash(offset, buffer.size()) >= 0) {
 		return CheckCdnHashResult::NoHash;
 	}
-	const auto realHash = openssl::Sha256(buffer);
-	const auto receivedHash = bytes::make_span(cdnFileHashIt->second.hash);
-	if (bytes::compare(realHash, receivedHash)) {
-		return CheckCdnHashResult::Invalid;
+	const auto full = int64(buffer.size());
+	auto checked = int64(0);
+	while (checked < full) {
+		const auto &hash = _cdnFileHashes.find(offset + checked)->second;
+		const auto size = std::min(int64(hash.limit), full - checked);
+		const auto realHash = openssl::Sha256(buffer.subspan(checked, size));
+		if (bytes::compare(realHash, bytes::make_span(hash.hash))) {
+			return CheckCdnHashResult::Invalid;
+		}
+		checked += size;
 	}
 	return CheckCdnHashResult::Good;
 }
 
+int64 DownloadMtprotoTask::firstMissingCdnFileHash(
+		int64 offset,
+		int size) const {
+	auto checked = int64(0);
+	while (checked < size) {
+		const auto i = _cdnFileHashes.find(offset + checked);
+		if (i == end(_cdnFileHashes) || i->second.limit <= 0) {
+			return offset + checked;
+		}
+		checked += i->second.limit;
+	}
+	return -1;
+}
+
 void DownloadMtprotoTask::reuploadDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId) {
@@ -754,7 +829,9 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 	const auto requestData = finishSentRequest(
 		requestId,
 		FinishRequestReason::Redirect);
+	const auto wasHashes = _cdnFileHashes.size();
 	addCdnHashes(result.v);
+	const auto someMoreHashes = (_cdnFileHashes.size() > wasHashes);
 	auto someMoreChecked = false;
 	for (auto i = _cdnUncheckedParts.begin(); i != _cdnUncheckedParts.cend();) {
 		const auto uncheckedData = i->first;
@@ -778,6 +855,7 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 			const auto goodBytes = std::move(i->second);
 			const auto weak = base::make_weak(this);
 			i = _cdnUncheckedParts.erase(i);
+			mayBeReadyToRequest();
 			if (!feedPart(goodOffset, goodBytes) || !weak) {
 				return;
 			}
@@ -786,7 +864,7 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 		default: Unexpected("Result of checkCdnFileHash()");
 		}
 	}
-	if (!someMoreChecked) {
+	if (!someMoreChecked && !someMoreHashes) {
 		LOG(("API Error: "
 			"Could not find cdnFileHash for offset %1 "
 			"after getCdnFileHashes request."
@@ -807,7 +885,7 @@ void DownloadMtprotoTask::placeSentRequest(
 	const auto amount = _owner->changeRequestedAmount(
 		dcId(),
 		requestData.sessionIndex,
-		Storage::kDownloadPartSize);
+		_partSize);
 	const auto &[i, ok1] = _sentRequests.emplace(requestId, requestData);
 	const auto &[j, ok2] = _requestByOffset.emplace(
 		requestData.offset,
@@ -851,9 +929,10 @@ auto DownloadMtprotoTask::finishSentRequest(
 	_owner->changeRequestedAmount(
 		dcId(),
 		result.sessionIndex,
-		-Storage::kDownloadPartSize);
+		-_partSize);
 	_sentRequests.erase(it);
 	const auto ok = _requestByOffset.remove(result.offset);
+	mayBeReadyToRequest();
 
 	if (_sentRequests.empty()) {
 		_nonPremiumLimitSubscription.destroy();
@@ -863,6 +942,7 @@ auto DownloadMtprotoTask::finishSentRequest(
 		_owner->requestSucceeded(
 			dcId(),
 			result.sessionIndex,
+			_partSize,
 			result.requestedInSession,
 			result.sent);
 	}
@@ -916,6 +996,10 @@ void DownloadMtprotoTask::removeFromQueue() {
 	_owner->remove(this);
 }
 
+void DownloadMtprotoTask::mayBeReadyToRequest() {
+	_owner->mayBeReadyToRequest(this);
+}
+
 void DownloadMtprotoTask::partLoaded(
 		int64 offset,
 		const QByteArray &bytes) {
@@ -8,6 +8,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "data/data_file_origin.h"
+#include "storage/details/storage_download_balance.h"
+#include "storage/details/storage_download_queue.h"
 #include "base/timer.h"
 #include "base/weak_ptr.h"
 
@@ -19,11 +21,7 @@ class Error;
 
 namespace Storage {
 
-// Different part sizes are not supported for now :(
-// Because we start downloading with some part size
-// and then we get a CDN-redirect where we support only
-// fixed part size download for hash checking.
-constexpr auto kDownloadPartSize = 128 * 1024;
+[[nodiscard]] int ChooseDownloadPartSize(int64 fullSize);
 
 class DownloadMtprotoTask;
 
@@ -40,6 +38,7 @@ public:
 
 	void enqueue(not_null<Task*> task, int priority);
 	void remove(not_null<Task*> task);
+	void mayBeReadyToRequest(not_null<Task*> task);
 
 	void notifyTaskFinished() {
 		_taskFinished.fire({});
@@ -52,11 +51,23 @@ public:
 	void requestSucceeded(
 		MTP::DcId dcId,
 		int index,
+		int partSize,
 		int amountAtRequestStart,
 		crl::time timeAtRequestStart);
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
 	[[nodiscard]] int chooseSessionIndex(MTP::DcId dcId) const;
 
+	struct Throughput {
+		int64 bytes = 0;
+		crl::time duration = 0; // While any requests were in flight.
+
+		[[nodiscard]] int64 bytesPerSecond() const {
+			return duration ? (bytes * 1000 / duration) : 0;
+		}
+	};
+	void partReceived(int bytes);
+	[[nodiscard]] Throughput throughput() const;
+
 	void notifyNonPremiumDelay(DocumentId id) {
 		_nonPremiumDelays.fire_copy(id);
 	}
@@ -65,39 +76,23 @@ public:
 	}
 
 private:
-	class Queue final {
-	public:
-		void enqueue(not_null<Task*> task, int priority);
-		void remove(not_null<Task*> task);
-		void resetGeneration();
-		[[nodiscard]] bool empty() const;
-		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
-		void removeSession(int index);
-
-	private:
-		struct Enqueued {
-			not_null<Task*> task;
-			int priority = 0;
-		};
-		std::vector<Enqueued> _tasks;
-
-	};
-	struct DcSessionBalanceData {
-		DcSessionBalanceData();
-
-		int requested = 0;
-		int successes = 0; // Since last timeout in this dc in any session.
-		int maxWaitedAmount = 0;
-	};
+	using Queue = details::DownloadQueue<Task>;
+	using DcSessionBalanceData = details::DownloadSessionBalance;
 	struct DcBalanceData {
 		DcBalanceData();
 
+		[[nodiscard]] int64 bandwidth() const;
+
 		std::vector<DcSessionBalanceData> sessions;
 		crl::time lastSessionRemove = 0;
 		int sessionRemoveIndex = 0;
 		int sessionRemoveTimes = 0;
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
+
+		// Bandwidth before the last session was added, to check it helped.
+		crl::time lastSessionAdd = 0;
+		int64 bandwidthBeforeAdd = 0;
 	};
 
 	void checkSendNext();
@@ -112,6 +107,7 @@ private:
 	void resetGeneration();
 	void sessionTimedOut(MTP::DcId dcId, int index);
 	void removeSession(MTP::DcId dcId);
+	void removeAddedSession(MTP::DcId dcId, int index);
 
 	const not_null<ApiWrap*> _api;
 
@@ -125,6 +121,11 @@ private:
 	base::Timer _killSessionsTimer;
 
 	base::flat_map<MTP::DcId, Queue> _queues;
+
+	Throughput _throughput;
+	crl::time _activeSince = 0;
+	int64 _totalRequested = 0;
+
 	rpl::lifetime _lifetime;
 
 };
@@ -153,6 +154,7 @@ public:
 	[[nodiscard]] Data::FileOrigin fileOrigin() const;
 	[[nodiscard]] uint64 objectId() const;
 	[[nodiscard]] const Location &location() const;
+	[[nodiscard]] int partSize() const;
 
 	[[nodiscard]] virtual bool readyToRequest() const = 0;
 	void loadPart(int sessionIndex);
@@ -172,6 +174,12 @@ protected:
 	void addToQueue(int priority = 0);
 	void removeFromQueue();
 
+	// Must be called when readyToRequest() may have become true.
+	void mayBeReadyToRequest();
+
+	// Must be called before any request is sent.
+	void setPartSize(int size);
+
 	[[nodiscard]] ApiWrap &api() const {
 		return _owner->api();
 	}
@@ -225,6 +233,9 @@ private:
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId);
 	void requestMoreCdnFileHashes();
+	[[nodiscard]] int64 firstMissingCdnFileHash(
+		int64 offset,
+		int size) const;
 	void getCdnFileHashesDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId);
@@ -265,6 +276,7 @@ private:
 
 	const not_null<DownloadManagerMtproto*> _owner;
 	const MTP::DcId _dcId = 0;
+	int _partSize = kDownloadPartSize;
 
 	// _location can be changed with an updated file_reference.
 	Location _location;
@@ -25,6 +25,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+// Wait for the background writes if more than that is not written yet.
+constexpr auto kMaxFileWritesPending = int64(16 * 1024 * 1024);
+
 class FromMemoryLoader final : public FileLoader {
 public:
 	FromMemoryLoader(
@@ -125,7 +128,10 @@ Main::Session &FileLoader::session() const {
 void FileLoader::finishWithBytes(const QByteArray &data) {
 	_data = data;
 	_localStatus = LocalStatus::Loaded;
-	if (!_filename.isEmpty() && _toCache == LoadToCacheAsWell) {
+	if (!finishFileWrites()) {
+		cancel(FailureReason::FileWriteFailure);
+		return;
+	} else if (!_filename.isEmpty() && _toCache == LoadToCacheAsWell) {
 		if (!_fileIsOpen) _fileIsOpen = _file.open(QIODevice::WriteOnly);
 		if (!_fileIsOpen) {
 			cancel(FailureReason::FileWriteFailure);
@@ -199,6 +205,7 @@ void FileLoader::increaseLoadSize(int64 size, bool autoLoading) {
 
 	_loadSize = size;
 	_autoLoading = autoLoading;
+	increaseLoadSizeHook();
 }
 
 void FileLoader::notifyAboutProgress() {
@@ -339,6 +346,7 @@ void FileLoader::cancel(FailureReason fail) {
 
 	_cancelled = true;
 	_finished = true;
+	finishFileWrites();
 	if (_fileIsOpen) {
 		_file.close();
 		_fileIsOpen = false;
@@ -359,7 +367,14 @@ void FileLoader::cancel(FailureReason fail) {
 }
 
 int64 FileLoader::currentOffset() const {
-	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
+	return (_fileIsOpen ? _fileSize : _data.size()) - _skippedBytes;
+}
+
+bool FileLoader::finishFileWrites() {
+	if (base::take(_fileWritesQueued)) {
+		_fileWriter.sync([] {});
+	}
+	return !_fileWriteFailed;
 }
 
 bool FileLoader::writeResultPart(int64 offset, bytes::const_span buffer) {
@@ -369,17 +384,38 @@ bool FileLoader::writeResultPart(int64 offset, bytes::const_span buffer) {
 		return true;
 	}
 	if (_fileIsOpen) {
-		auto fsize = _file.size();
+		if (_fileWriteFailed
+			|| (_fileWritesPending > kMaxFileWritesPending
+				&& !finishFileWrites())) {
+			cancel(FailureReason::FileWriteFailure);
+			return false;
+		}
+		const auto fsize = _fileSize;
+		const auto size = int64(buffer.size());
 		if (offset < fsize) {
-			_skippedBytes -= buffer.size();
+			_skippedBytes -= size;
 		} else if (offset > fsize) {
 			_skippedBytes += offset - fsize;
 		}
-		_file.seek(offset);
-		if (_file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) != qint64(buffer.size())) {
-			cancel(FailureReason::FileWriteFailure);
-			return false;
-		}
+		_fileSize = std::max(fsize, offset + size);
+
+		// Write on a background thread, so that slow disks
+		// don't block the main thread for each received part.
+		_fileWritesPending += size;
+		_fileWritesQueued = true;
+		_fileWriter.async([
+			=,
+			data = QByteArray(
+				reinterpret_cast<const char*>(buffer.data()),
+				buffer.size())
+		] {
+			if (!_fileWriteFailed
+				&& (!_file.seek(offset)
+					|| _file.write(data) != qint64(data.size()))) {
+				_fileWriteFailed = true;
+			}
+			_fileWritesPending -= size;
+		});
 		return true;
 	}
 	_data.reserve(offset + buffer.size());
@@ -406,7 +442,10 @@ QByteArray FileLoader::readLoadedPartBack(int64 offset, int size) {
 	Expects(offset >= 0 && size > 0);
 
 	if (_fileIsOpen) {
-		if (_file.openMode() == QIODevice::WriteOnly) {
+		if (!finishFileWrites()) {
+			cancel(FailureReason::FileWriteFailure);
+			return QByteArray();
+		} else if (_file.openMode() == QIODevice::WriteOnly) {
 			_file.close();
 			_fileIsOpen = _file.open(QIODevice::ReadWrite);
 			if (!_fileIsOpen) {
@@ -428,7 +467,10 @@ QByteArray FileLoader::readLoadedPartBack(int64 offset, int size) {
 bool FileLoader::finalizeResult() {
 	Expects(!_finished);
 
-	if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
+	if (!finishFileWrites()) {
+		cancel(FailureReason::FileWriteFailure);
+		return false;
+	} else if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
 		if (!_fileIsOpen) {
 			_fileIsOpen = _file.open(QIODevice::WriteOnly);
 		}
@@ -12,6 +12,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtNetwork/QNetworkReply>
 
+#include <atomic>
+
 namespace Data {
 struct FileOrigin;
 } // namespace Data
@@ -152,6 +154,8 @@ protected:
 	virtual void startLoadingWithPartial(const QByteArray &data) {
 		startLoading();
 	}
+	virtual void increaseLoadSizeHook() {
+	}
 
 	void cancel(FailureReason failed);
 
@@ -159,6 +163,7 @@ protected:
 
 	bool writeResultPart(int64 offset, bytes::const_span buffer);
 	bool finalizeResult();
+	bool finishFileWrites();
 	[[nodiscard]] QByteArray readLoadedPartBack(int64 offset, int size);
 
 	const not_null<Main::Session*> _session;
@@ -173,6 +178,14 @@ protected:
 	QFile _file;
 	bool _fileIsOpen = false;
 
+	// Parts are written to _file on _fileWriter, the main thread
+	// touches _file only after finishFileWrites().
+	crl::queue _fileWriter;
+	int64 _fileSize = 0;
+	std::atomic<int64> _fileWritesPending = 0;
+	std::atomic<bool> _fileWriteFailed = false;
+	bool _fileWritesQueued = false;
+
 	LoadToCacheSetting _toCache;
 	LoadFromCloudSetting _fromCloud;
 
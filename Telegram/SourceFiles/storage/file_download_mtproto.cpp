@@ -39,6 +39,7 @@ mtpFileLoader::mtpFileLoader(
 	autoLoading,
 	cacheTag)
 , DownloadMtprotoTask(&session->downloader(), location, origin) {
+	setPartSize(Storage::ChooseDownloadPartSize(loadSize));
 }
 
 mtpFileLoader::mtpFileLoader(
@@ -138,7 +139,7 @@ int64 mtpFileLoader::takeNextRequestOffset() {
 	Expects(readyToRequest());
 
 	const auto result = _nextRequestOffset;
-	_nextRequestOffset += Storage::kDownloadPartSize;
+	_nextRequestOffset += partSize();
 	return result;
 }
 
@@ -188,8 +189,8 @@ void mtpFileLoader::startLoadingWithPartial(const QByteArray &data) {
 	Expects(data.startsWith("partial:"));
 
 	constexpr auto kPrefix = 8;
-	const auto parts = (data.size() - kPrefix) / Storage::kDownloadPartSize;
-	const auto use = parts * int64(Storage::kDownloadPartSize);
+	const auto parts = (data.size() - kPrefix) / partSize();
+	const auto use = parts * int64(partSize());
 	if (use > 0) {
 		_nextRequestOffset = use;
 		feedPart(0, QByteArray::fromRawData(data.data() + kPrefix, use));
@@ -201,6 +202,10 @@ void mtpFileLoader::cancelHook() {
 	cancelAllRequests();
 }
 
+void mtpFileLoader::increaseLoadSizeHook() {
+	mayBeReadyToRequest();
+}
+
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
 	return v::match(location().data, [&](const WebFileLocation &location) {
 		return Data::WebDocumentCacheKey(location);
@@ -26,8 +26,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Storage {
 namespace {
 
-// max 1mb uploaded at the same time in each session
-constexpr auto kMaxUploadPerSession = 1024 * 1024;
+// Log per session upload speed not more often than that.
+constexpr auto kUploadStatsLogTimeout = 10 * crl::time(1000);
 
 constexpr auto kDocumentMaxPartsCountDefault = 4000;
 
@@ -63,6 +63,17 @@ constexpr auto kSlowRequestThreshold = 8 * crl::time(1000);
 // (it-s size + queued before size) >= 512kb.
 constexpr auto kAcceptAsFastIfTotalAtLeast = 512 * 1024;
 
+// Reads document parts sequentially from disk. While one part is being
+// uploaded the next one is read ahead on a background thread.
+struct DocFileReader {
+	explicit DocFileReader(const QString &path) : file(path) {
+	}
+
+	QMutex mutex;
+	QFile file;
+	QByteArray next;
+};
+
 [[nodiscard]] const char *ThumbnailFormat(const QString &mime) {
 	return Core::IsMimeSticker(mime) ? "WEBP" : "JPG";
 }
@@ -87,7 +98,7 @@ struct Uploader::Entry {
 
 	HashMd5 md5Hash;
 
-	std::unique_ptr<QFile> docFile;
+	std::shared_ptr<DocFileReader> docFile;
 	int64 docSize = 0;
 	int64 docSentSize = 0;
 	int docPartSize = 0;
@@ -133,7 +144,12 @@ void Uploader::Entry::setDocSize(int64 size) {
 	docSize = size;
 	constexpr auto limit0 = 1024 * 1024;
 	constexpr auto limit1 = 32 * limit0;
-	if (docSize >= limit0 || !setPartSize(kDocumentUploadPartSize0)) {
+	if (docSize > kUseBigFilesFrom) {
+		// Big file parts are uploaded in several sessions in parallel,
+		// so larger parts mean less requests waiting for round trips.
+		setPartSize(kDocumentUploadPartSize4);
+	} else if (docSize >= limit0
+		|| !setPartSize(kDocumentUploadPartSize0)) {
 		if (docSize > limit1 || !setPartSize(kDocumentUploadPartSize1)) {
 			if (!setPartSize(kDocumentUploadPartSize2)) {
 				if (!setPartSize(kDocumentUploadPartSize3)) {
@@ -377,6 +393,7 @@ void Uploader::stopSessions() {
 			_api->instance().stopSession(MTP::uploadDcId(i));
 		}
 		_sentPerDcIndex.clear();
+		_windowPerDcIndex.clear();
 		_dcIndicesWithFastRequests.clear();
 	}
 }
@@ -403,12 +420,61 @@ QByteArray Uploader::readDocPart(not_null<Entry*> entry) {
 		return checked(content.mid(offset, entry->docPartSize));
 	} else if (!entry->docFile) {
 		const auto filepath = entry->file->filepath;
-		entry->docFile = std::make_unique<QFile>(filepath);
-		if (!entry->docFile->open(QIODevice::ReadOnly)) {
+		entry->docFile = std::make_shared<DocFileReader>(filepath);
+		if (!entry->docFile->file.open(QIODevice::ReadOnly)) {
 			return QByteArray();
 		}
 	}
-	return checked(entry->docFile->read(entry->docPartSize));
+	const auto reader = entry->docFile;
+	const auto size = entry->docPartSize;
+	auto result = QByteArray();
+	{
+		// Waits for the read ahead, if it is in progress right now.
+		QMutexLocker lock(&reader->mutex);
+		result = reader->next.isEmpty()
+			? reader->file.read(size)
+			: base::take(reader->next);
+	}
+	if (entry->docPartsSent + 1 < entry->docPartsCount) {
+		crl::async([=] {
+			QMutexLocker lock(&reader->mutex);
+			if (reader->next.isEmpty()) {
+				reader->next = reader->file.read(size);
+			}
+		});
+	}
+	return checked(std::move(result));
+}
+
+bool Uploader::dcIndexFull(uchar dcIndex, int64 bytes) const {
+	const auto &window = _windowPerDcIndex[dcIndex].window;
+	return window.full(_sentPerDcIndex[dcIndex], bytes);
+}
+
+void Uploader::updateDcIndexWindow(
+		const Request &request,
+		crl::time duration) {
+	auto &window = _windowPerDcIndex[request.dcIndex];
+	const auto bytes = int(request.bytes.size());
+	const auto now = request.sent + duration;
+	window.window.requestDone(
+		request.sent,
+		now,
+		bytes,
+		(duration < kFastRequestThreshold));
+
+	window.uploaded += bytes;
+	if (!window.statsStarted) {
+		window.statsStarted = request.sent;
+	} else if (now - window.statsStarted >= kUploadStatsLogTimeout) {
+		const auto elapsed = now - window.statsStarted;
+		DEBUG_LOG(("Uploader: dc index %1 sent %2 KB/s, window %3 KB."
+			).arg(request.dcIndex
+			).arg(window.uploaded * 1000 / (elapsed * 1024)
+			).arg(window.window.size / 1024));
+		window.uploaded = 0;
+		window.statsStarted = now;
+	}
 }
 
 bool Uploader::canAddDcIndex() const {
@@ -427,6 +493,7 @@ std::optional<uchar> Uploader::chooseDcIndexForNextRequest(
 	if (canAddDcIndex()) {
 		const auto result = int(_sentPerDcIndex.size());
 		_sentPerDcIndex.push_back(0);
+		_windowPerDcIndex.push_back({});
 		_dcIndicesWithFastRequests.clear();
 		_latestDcIndexAdded = crl::now();
 
@@ -521,9 +588,7 @@ auto Uploader::sendPendingPart(not_null<Entry*> entry, uchar dcIndex)
 auto Uploader::sendDocPart(not_null<Entry*> entry, uchar dcIndex)
 -> SendResult {
 	const auto itemId = entry->itemId;
-	const auto alreadySent = _sentPerDcIndex[dcIndex];
-	const auto willProbablyBeSent = entry->docPartSize;
-	if (alreadySent + willProbablyBeSent > kMaxUploadPerSession) {
+	if (dcIndexFull(dcIndex, entry->docPartSize)) {
 		return SendResult::DcIndexFull;
 	}
 
@@ -567,9 +632,8 @@ auto Uploader::sendDocPart(not_null<Entry*> entry, uchar dcIndex)
 auto Uploader::sendSlicedPart(not_null<Entry*> entry, uchar dcIndex)
 -> SendResult {
 	const auto itemId = entry->itemId;
-	const auto alreadySent = _sentPerDcIndex[dcIndex];
 	const auto willBeSent = entry->parts->at(entry->partsSent).size();
-	if (alreadySent + willBeSent >= kMaxUploadPerSession) {
+	if (dcIndexFull(dcIndex, willBeSent)) {
 		return SendResult::DcIndexFull;
 	}
 
@@ -712,6 +776,7 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 	const auto now = crl::now();
 	const auto duration = now - request.sent;
 	const auto fast = (duration < kFastRequestThreshold);
+	updateDcIndexWindow(request, duration);
 	const auto slowish = !fast;
 	const auto slow = (duration >= kSlowRequestThreshold);
 
@@ -798,6 +863,7 @@ void Uploader::removeDcIndex() {
 	}
 	Assert(_sentPerDcIndex.back() == 0);
 	_sentPerDcIndex.pop_back();
+	_windowPerDcIndex.pop_back();
 	_dcIndicesWithFastRequests.remove(dcIndex);
 	_api->instance().stopSession(MTP::uploadDcId(dcIndex));
 	DEBUG_LOG(("Uploader: Removed dc index %1.").arg(dcIndex));
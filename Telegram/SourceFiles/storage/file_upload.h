@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/timer.h"
 #include "base/weak_ptr.h"
 #include "mtproto/facade.h"
+#include "storage/details/storage_upload_window.h"
 
 class ApiWrap;
 struct FilePrepareResult;
@@ -102,6 +103,13 @@ public:
 private:
 	struct Entry;
 	struct Request;
+	struct DcIndexWindow {
+		details::UploadSessionWindow window;
+
+		// Written to the debug log only.
+		int64 uploaded = 0;
+		crl::time statsStarted = 0;
+	};
 
 	enum class SendResult : uchar {
 		Success,
@@ -111,6 +119,8 @@ private:
 
 	void maybeSend();
 	[[nodiscard]] bool canAddDcIndex() const;
+	[[nodiscard]] bool dcIndexFull(uchar dcIndex, int64 bytes) const;
+	void updateDcIndexWindow(const Request &request, crl::time duration);
 	[[nodiscard]] std::optional<uchar> chooseDcIndexForNextRequest(
 		const base::flat_set<uchar> &used);
 	[[nodiscard]] Entry *chooseEntryForNextRequest();
@@ -156,6 +166,7 @@ private:
 
 	base::flat_map<mtpRequestId, Request> _requests;
 	std::vector<int> _sentPerDcIndex;
+	std::vector<DcIndexWindow> _windowPerDcIndex;
 
 	// Fast requests since the latest dc index addition.
 	base::flat_set<uchar> _dcIndicesWithFastRequests;
@@ -222,7 +222,8 @@ int PhotoSideLimit() {
 	return PhotoSideLimit(SendLargePhotos.value());
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int threads)
+: _threadsCount(std::max(threads, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -238,7 +239,7 @@ TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 		_tasksToProcess.push_back(std::move(task));
 	}
 
-	wakeThread();
+	wakeThreads();
 
 	return result;
 }
@@ -251,44 +252,65 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 		}
 	}
 
-	wakeThread();
+	wakeThreads();
 }
 
-void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
-
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
-
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
-
-		_thread->start();
+void TaskQueue::wakeThreads() {
+	if (_threads.empty()) {
+		_threads.reserve(_threadsCount);
+		_workers.reserve(_threadsCount);
+		for (auto i = 0; i != _threadsCount; ++i) {
+			const auto thread = new QThread();
+			const auto worker = new TaskQueueWorker(this);
+			worker->moveToThread(thread);
+
+			connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+			connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+
+			thread->start();
+			_threads.push_back(thread);
+			_workers.push_back(worker);
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	taskAdded();
 }
 
 void TaskQueue::cancelTask(TaskId id) {
-	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
+	{
+		QMutexLocker lock(&_tasksToProcessMutex);
 		const auto proj = [](const std::unique_ptr<Task> &task) {
 			return task->id();
 		};
-		auto i = ranges::find(queue, id, proj);
-		if (i != queue.end()) {
-			queue.erase(i);
+		const auto i = ranges::find(_tasksToProcess, id, proj);
+		if (i != end(_tasksToProcess)) {
+			_tasksToProcess.erase(i);
 		}
-	};
+	}
+
+	// If the task is still in process the worker won't find its entry
+	// and will just destroy the task after process() returns.
+	auto removed = std::unique_ptr<Task>();
+	auto wasFirst = false;
 	{
-		QMutexLocker lock(&_tasksToProcessMutex);
-		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		QMutexLocker lock(&_tasksToFinishMutex);
+		const auto i = ranges::find(
+			_tasksToFinish,
+			id,
+			&TaskToFinish::id);
+		if (i != end(_tasksToFinish)) {
+			wasFirst = (i == begin(_tasksToFinish));
+			removed = std::move(i->task);
+			_tasksToFinish.erase(i);
 		}
 	}
-	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+
+	// Processed tasks after the cancelled one may be waiting for it.
+	if (wasFirst) {
+		crl::on_main(this, [=] {
+			onTaskProcessed();
+		});
+	}
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -296,33 +318,41 @@ void TaskQueue::onTaskProcessed() {
 		auto task = std::unique_ptr<Task>();
 		{
 			QMutexLocker lock(&_tasksToFinishMutex);
-			if (_tasksToFinish.empty()) break;
-			task = std::move(_tasksToFinish.front());
+			if (_tasksToFinish.empty() || !_tasksToFinish.front().task) {
+				break;
+			}
+			task = std::move(_tasksToFinish.front().task);
 			_tasksToFinish.pop_front();
 		}
 		task->finish();
 	} while (true);
 
 	if (_stopTimer) {
-		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		QMutexLocker lockToProcess(&_tasksToProcessMutex);
+		QMutexLocker lockToFinish(&_tasksToFinishMutex);
+		if (_tasksToProcess.empty() && _tasksToFinish.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
-		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	for (const auto thread : _threads) {
+		thread->requestInterruption();
+		thread->quit();
+	}
+	if (!_threads.empty()) {
+		DEBUG_LOG(("Waiting for taskThreads to finish"));
+	}
+	for (const auto thread : base::take(_threads)) {
+		thread->wait();
+		delete thread;
+	}
+	for (const auto worker : base::take(_workers)) {
+		delete worker;
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
 }
 
 TaskQueue::~TaskQueue() {
@@ -334,38 +364,41 @@ void TaskQueueWorker::onTaskAdded() {
 	if (_inTaskAdded) return;
 	_inTaskAdded = true;
 
-	bool someTasksLeft = false;
 	do {
 		auto task = std::unique_ptr<Task>();
 		{
-			QMutexLocker lock(&_queue->_tasksToProcessMutex);
-			if (!_queue->_tasksToProcess.empty()) {
-				task = std::move(_queue->_tasksToProcess.front());
-				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
+			QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
+			if (_queue->_tasksToProcess.empty()) {
+				break;
 			}
+			task = std::move(_queue->_tasksToProcess.front());
+			_queue->_tasksToProcess.pop_front();
+
+			// Reserve the place in the finish order while still holding
+			// the process lock, so that the order matches addTask() order.
+			QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
+			_queue->_tasksToFinish.push_back({ .id = task->id() });
 		}
 
-		if (task) {
-			task->process();
-			bool emitTaskProcessed = false;
-			{
-				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
-				}
-			}
-			if (emitTaskProcessed) {
-				taskProcessed();
+		task->process();
+		auto emitTaskProcessed = false;
+		{
+			QMutexLocker lock(&_queue->_tasksToFinishMutex);
+			auto &list = _queue->_tasksToFinish;
+			const auto i = ranges::find(
+				list,
+				task->id(),
+				&TaskQueue::TaskToFinish::id);
+			if (i != end(list)) {
+				emitTaskProcessed = (i == begin(list));
+				i->task = std::move(task);
 			}
 		}
+		if (emitTaskProcessed) {
+			taskProcessed();
+		}
 		QCoreApplication::processEvents();
-	} while (someTasksLeft && !thread()->isInterruptionRequested());
+	} while (!thread()->isInterruptionRequested());
 
 	_inTaskAdded = false;
 }
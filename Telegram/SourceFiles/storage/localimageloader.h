@@ -56,7 +56,10 @@ class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	// stopTimeoutMs <= 0 - never stop workers.
+	// Tasks are processed by up to 'threads' workers in parallel,
+	// but finish() is always called in the order the tasks were added.
+	explicit TaskQueue(crl::time stopTimeoutMs = 0, int threads = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -74,15 +77,20 @@ public Q_SLOTS:
 private:
 	friend class TaskQueueWorker;
 
-	void wakeThread();
+	struct TaskToFinish {
+		TaskId id = kEmptyTaskId;
+		std::unique_ptr<Task> task; // nullptr while in process.
+	};
+
+	void wakeThreads();
 
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
-	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	std::deque<TaskToFinish> _tasksToFinish;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	std::vector<QThread*> _threads;
+	std::vector<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer = nullptr;
+	int _threadsCount = 1;
 
 };
 
@@ -2779,7 +2779,10 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	}
 	quint32 size = sizeof(quint32) * 6
 		+ Serialize::stringSize(settings.path)
-		+ sizeof(qint32) * 2 + sizeof(quint64);
+		+ sizeof(qint32) * 2 + sizeof(quint64)
+		+ sizeof(qint32)
+		+ Serialize::stringSize(settings.previousCheckpoint)
+		+ sizeof(qint32);
 	EncryptedDescriptor data(size);
 	data.stream
 		<< quint32(settings.types)
@@ -2812,6 +2815,9 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	});
 	data.stream << qint32(settings.singlePeerFrom);
 	data.stream << qint32(settings.singlePeerTill);
+	data.stream << qint32(settings.incremental ? 1 : 0);
+	data.stream << settings.previousCheckpoint;
+	data.stream << qint32(settings.media.partsInFlight);
 
 	FileWriteDescriptor file(_exportSettingsKey, _basePath);
 	file.writeEncrypted(data, _localKey);
@@ -2834,6 +2840,9 @@ Export::Settings Account::readExportSettings() {
 	quint64 singlePeerBareId = 0;
 	quint64 singlePeerAccessHash = 0;
 	qint32 singlePeerFrom = 0, singlePeerTill = 0;
+	qint32 incremental = 0;
+	QString previousCheckpoint;
+	qint32 partsInFlight = Export::MediaSettings().partsInFlight;
 	file.stream
 		>> types
 		>> fullChats
@@ -2864,11 +2873,18 @@ Export::Settings Account::readExportSettings() {
 	if (!file.stream.atEnd()) {
 		file.stream >> singlePeerFrom >> singlePeerTill;
 	}
+	if (!file.stream.atEnd()) {
+		file.stream >> incremental >> previousCheckpoint;
+	}
+	if (!file.stream.atEnd()) {
+		file.stream >> partsInFlight;
+	}
 	auto result = Export::Settings();
 	result.types = Export::Settings::Types::from_raw(types);
 	result.fullChats = Export::Settings::Types::from_raw(fullChats);
 	result.media.types = Export::MediaSettings::Types::from_raw(mediaTypes);
 	result.media.sizeLimit = mediaSizeLimit;
+	result.media.partsInFlight = partsInFlight;
 	result.format = Export::Output::Format(format);
 	result.path = path;
 	result.availableAt = availableAt;
@@ -2904,6 +2920,8 @@ Export::Settings Account::readExportSettings() {
 	}();
 	result.singlePeerFrom = singlePeerFrom;
 	result.singlePeerTill = singlePeerTill;
+	result.incremental = (incremental == 1);
+	result.previousCheckpoint = previousCheckpoint;
 	return (file.stream.status() == QDataStream::Ok && result.validate())
 		? result
 		: Export::Settings();
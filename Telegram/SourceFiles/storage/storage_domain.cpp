@@ -29,6 +29,12 @@ using namespace details;
 	return "key_" + dataName;
 }
 
+void LogPhase(const char *phase, crl::time started) {
+	LOG(("App Info: %1 took %2 ms."
+		).arg(phase
+		).arg(crl::now() - started));
+}
+
 } // namespace
 
 Domain::Domain(not_null<Main::Domain*> owner, const QString &dataName)
@@ -39,23 +45,31 @@ Domain::Domain(not_null<Main::Domain*> owner, const QString &dataName)
 Domain::~Domain() = default;
 
 StartResult Domain::start(const QByteArray &passcode) {
+	const auto started = crl::now();
 	const auto modern = startModern(passcode);
 	if (modern == StartModernResult::Success) {
 		if (_oldVersion < AppVersion) {
+			const auto writing = crl::now();
 			writeAccounts();
+			LogPhase("writing accounts", writing);
 		}
+		LogPhase("domain start", started);
 		return StartResult::Success;
 	} else if (modern == StartModernResult::IncorrectPasscode) {
 		return StartResult::IncorrectPasscode;
 	} else if (modern == StartModernResult::Failed) {
 		startFromScratch();
+		LogPhase("domain start from scratch", started);
 		return StartResult::Success;
 	}
+	const auto legacyStarted = crl::now();
 	auto legacy = std::make_unique<Main::Account>(_owner, _dataName, 0);
 	const auto result = legacy->legacyStart(passcode);
+	LogPhase("legacy account start", legacyStarted);
 	if (result == StartResult::Success) {
 		_oldVersion = legacy->local().oldMapVersion();
 		startWithSingleAccount(passcode, std::move(legacy));
+		LogPhase("domain legacy start", started);
 	}
 	return result;
 }
@@ -93,11 +107,11 @@ void Domain::generateLocalKey() {
 	Expects(_passcodeKeySalt.isEmpty());
 	Expects(_passcodeKeyEncrypted.isEmpty());
 
-	auto pass = QByteArray(MTP::AuthKey::kSize, Qt::Uninitialized);
-	auto salt = QByteArray(LocalEncryptSaltSize, Qt::Uninitialized);
-	base::RandomFill(pass.data(), pass.size());
-	base::RandomFill(salt.data(), salt.size());
-	_localKey = CreateLocalKey(pass, salt);
+	// The local key is stored only encrypted by the passcode key, so
+	// there is nothing to gain from stretching random bytes with KDF.
+	auto key = MTP::AuthKey::Data();
+	base::RandomFill(key.data(), key.size());
+	_localKey = std::make_shared<MTP::AuthKey>(key);
 
 	encryptLocalKey(QByteArray());
 }
@@ -118,9 +132,11 @@ Domain::StartModernResult Domain::startModern(
 	const auto name = ComputeKeyName(_dataName);
 
 	FileReadDescriptor keyData;
+	const auto reading = crl::now();
 	if (!ReadFile(keyData, name, BaseGlobalPath())) {
 		return StartModernResult::Empty;
 	}
+	LogPhase("reading key file", reading);
 	LOG(("App Info: reading accounts info..."));
 
 	QByteArray salt, keyEncrypted, infoEncrypted;
@@ -133,7 +149,9 @@ Domain::StartModernResult Domain::startModern(
 		LOG(("App Error: bad salt in info file, size: %1").arg(salt.size()));
 		return StartModernResult::Failed;
 	}
+	const auto deriving = crl::now();
 	_passcodeKey = CreateLocalKey(passcode, salt);
+	LogPhase("passcode key derivation", deriving);
 
 	EncryptedDescriptor keyInnerData, info;
 	if (!DecryptLocal(keyInnerData, keyEncrypted, _passcodeKey)) {
@@ -167,6 +185,7 @@ Domain::StartModernResult Domain::startModern(
 
 	_oldVersion = keyData.version;
 
+	const auto accountsStarted = crl::now();
 	auto tried = base::flat_set<int>();
 	auto sessions = base::flat_set<uint64>();
 	auto active = 0;
@@ -197,6 +216,7 @@ Domain::StartModernResult Domain::startModern(
 			}
 		}
 	}
+	LogPhase("accounts start", accountsStarted);
 	if (sessions.empty()) {
 		LOG(("App Error: no accounts read."));
 		return StartModernResult::Failed;
@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <cstdio>
+
+// Console tests for the logic that doesn't need the application,
+// each of them is a separate executable returning non zero on failure.
+
+namespace Test {
+
+[[nodiscard]] inline int &FailedChecks() {
+	static auto result = 0;
+	return result;
+}
+
+inline void Check(
+		bool condition,
+		const char *description,
+		const char *file,
+		int line) {
+	if (!condition) {
+		++FailedChecks();
+		std::fprintf(
+			stderr,
+			"%s:%d: check failed: %s\n",
+			file,
+			line,
+			description);
+	}
+}
+
+[[nodiscard]] inline int ChecksResult(const char *name) {
+	if (const auto failed = FailedChecks()) {
+		std::fprintf(stderr, "%s: %d checks failed.\n", name, failed);
+		return 1;
+	}
+	std::printf("%s: all checks passed.\n", name);
+	return 0;
+}
+
+} // namespace Test
+
+#define TEST_CHECK(condition) \
+	::Test::Check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,203 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "data/data_group_call_participants.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct FakeParticipant {
+	int peer = 0;
+	bool speaking = false;
+	bool sounding = false;
+
+	friend inline bool operator==(
+		const FakeParticipant &,
+		const FakeParticipant &) = default;
+};
+
+using Participants = Data::IndexedParticipants<int, FakeParticipant>;
+
+// The plain vector with a linear scan the index has replaced.
+class ReferenceParticipants final {
+public:
+	[[nodiscard]] const std::vector<FakeParticipant> &list() const {
+		return _list;
+	}
+	[[nodiscard]] FakeParticipant *find(int peer) {
+		const auto i = std::find_if(
+			begin(_list),
+			end(_list),
+			[&](const FakeParticipant &p) { return p.peer == peer; });
+		return (i != end(_list)) ? &*i : nullptr;
+	}
+	void add(int peer, FakeParticipant participant) {
+		_list.push_back(participant);
+	}
+	void remove(int peer) {
+		const auto i = std::find_if(
+			begin(_list),
+			end(_list),
+			[&](const FakeParticipant &p) { return p.peer == peer; });
+		if (i != end(_list)) {
+			_list.erase(i);
+		}
+	}
+
+private:
+	std::vector<FakeParticipant> _list;
+
+};
+
+struct Update {
+	enum class Type {
+		Spoke,
+		Join,
+		Leave,
+	};
+	Type type = Type::Spoke;
+	int peer = 0;
+	bool speaking = false;
+};
+
+// Mostly speaking updates for the current participants, like the ones
+// coming every few hundred milliseconds in a large voice chat.
+[[nodiscard]] std::vector<Update> GenerateReplay(
+		int participants,
+		int count) {
+	auto generator = std::mt19937(20240811);
+	auto result = std::vector<Update>();
+	result.reserve(count);
+	auto nextPeer = participants;
+	for (auto i = 0; i != count; ++i) {
+		const auto kind = int(generator() % 1000);
+		const auto peer = int(generator() % nextPeer);
+		if (kind < 2) {
+			result.push_back({ Update::Type::Join, nextPeer++ });
+		} else if (kind < 4) {
+			result.push_back({ Update::Type::Leave, peer });
+		} else {
+			const auto speaking = (generator() % 2) != 0;
+			result.push_back({ Update::Type::Spoke, peer, speaking });
+		}
+	}
+	return result;
+}
+
+template <typename List>
+void Fill(List &list, int participants) {
+	for (auto peer = 0; peer != participants; ++peer) {
+		list.add(peer, { .peer = peer });
+	}
+}
+
+template <typename List>
+[[nodiscard]] int Replay(List &list, const std::vector<Update> &updates) {
+	auto changed = 0;
+	for (const auto &update : updates) {
+		switch (update.type) {
+		case Update::Type::Spoke:
+			if (const auto participant = list.find(update.peer)) {
+				if (participant->speaking != update.speaking) {
+					participant->speaking = update.speaking;
+					participant->sounding = update.speaking;
+					++changed;
+				}
+			}
+			break;
+		case Update::Type::Join:
+			if (!list.find(update.peer)) {
+				list.add(update.peer, { .peer = update.peer });
+			}
+			break;
+		case Update::Type::Leave:
+			list.remove(update.peer);
+			break;
+		}
+	}
+	return changed;
+}
+
+void TestAddFindRemove() {
+	auto participants = Participants();
+	Fill(participants, 4);
+	TEST_CHECK(participants.size() == 4);
+	TEST_CHECK(participants.find(2) == &participants.list()[2]);
+	TEST_CHECK(participants.find(7) == nullptr);
+
+	// The order is kept and the positions after the removed one shift.
+	participants.remove(1);
+	TEST_CHECK(participants.size() == 3);
+	TEST_CHECK(!participants.contains(1));
+	TEST_CHECK(participants.find(2) == &participants.list()[1]);
+	TEST_CHECK(participants.find(3)->peer == 3);
+	participants.remove(1);
+	TEST_CHECK(participants.size() == 3);
+
+	participants.add(1, { .peer = 1 });
+	TEST_CHECK(participants.list().back().peer == 1);
+	TEST_CHECK(participants.find(1) == &participants.list()[3]);
+
+	participants.clear();
+	TEST_CHECK(!participants.size());
+	TEST_CHECK(participants.find(0) == nullptr);
+}
+
+void TestReplaySameAsReference() {
+	constexpr auto kParticipants = 10000;
+	constexpr auto kUpdates = 200000;
+
+	const auto updates = GenerateReplay(kParticipants, kUpdates);
+
+	auto participants = Participants();
+	auto reference = ReferenceParticipants();
+	Fill(participants, kParticipants);
+	Fill(reference, kParticipants);
+
+	const auto measure = [&](auto &list) {
+		const auto start = std::chrono::steady_clock::now();
+		const auto changed = Replay(list, updates);
+		const auto duration = std::chrono::steady_clock::now() - start;
+		const auto ms = std::chrono::duration<double, std::milli>(
+			duration).count();
+		return std::make_pair(changed, ms);
+	};
+	const auto [changed, indexed] = measure(participants);
+	const auto [referenceChanged, linear] = measure(reference);
+	std::printf(
+		"%d participants, %d updates: %.2f ms, linear scan: %.2f ms\n",
+		kParticipants,
+		kUpdates,
+		indexed,
+		linear);
+
+	TEST_CHECK(changed == referenceChanged);
+	TEST_CHECK(participants.list() == reference.list());
+	auto mismatches = 0;
+	for (const auto &participant : reference.list()) {
+		const auto found = participants.find(participant.peer);
+		if (!found || *found != participant) {
+			++mismatches;
+		}
+	}
+	TEST_CHECK(mismatches == 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestAddFindRemove();
+	TestReplaySameAsReference();
+	return Test::ChecksResult("test_data_group_call_participants");
+}
@@ -0,0 +1,231 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "dialogs/dialogs_name_index.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto kEntriesCount = 300;
+constexpr auto kOperationsCount = 20000;
+
+using Index = Dialogs::NamePrefixIndex<int>;
+
+struct Entry {
+	base::flat_set<QString> words;
+	bool tracked = true;
+};
+
+// A model of IndexedList: the entries in the list order and
+// the prefix index, renames of untracked entries are not re-indexed.
+class Model final {
+public:
+	void add(int key, QStringList words, bool tracked) {
+		auto &entry = _entries[key];
+		entry.words = base::flat_set<QString>(words.begin(), words.end());
+		entry.tracked = tracked;
+		if (std::find(begin(_order), end(_order), key) == end(_order)) {
+			_order.push_back(key);
+		}
+		if (tracked) {
+			_index.add(key, entry.words);
+		} else {
+			_index.addUntracked(key);
+		}
+	}
+	void rename(int key, QStringList words) {
+		auto &entry = _entries[key];
+		entry.words = base::flat_set<QString>(words.begin(), words.end());
+		if (entry.tracked) {
+			_index.add(key, entry.words);
+		}
+	}
+	void remove(int key) {
+		_entries.erase(key);
+		_order.erase(std::find(begin(_order), end(_order), key));
+		_index.remove(key);
+	}
+	void moveToTop(int key) {
+		const auto i = std::find(begin(_order), end(_order), key);
+		std::rotate(begin(_order), i, i + 1);
+	}
+	[[nodiscard]] const std::vector<int> &order() const {
+		return _order;
+	}
+
+	// The first letter list scan IndexedList::filtered() used before.
+	[[nodiscard]] std::vector<int> scanned(const QStringList &words) const {
+		auto result = std::vector<int>();
+		for (const auto key : _order) {
+			if (Dialogs::NameWordsMatch(_entries.at(key).words, words)) {
+				result.push_back(key);
+			}
+		}
+		return result;
+	}
+
+	[[nodiscard]] std::vector<int> filtered(const QStringList &words) const {
+		const auto candidates = _index.candidates(words, _order.size());
+		if (!candidates) {
+			return scanned(words);
+		}
+		auto result = std::vector<int>();
+		for (const auto key : *candidates) {
+			const auto i = _entries.find(key);
+			if (i != end(_entries)
+				&& Dialogs::NameWordsMatch(i->second.words, words)) {
+				result.push_back(key);
+			}
+		}
+		const auto position = [&](int key) {
+			return std::find(begin(_order), end(_order), key) - begin(_order);
+		};
+		std::sort(begin(result), end(result), [&](int a, int b) {
+			return position(a) < position(b);
+		});
+		return result;
+	}
+
+private:
+	std::map<int, Entry> _entries;
+	std::vector<int> _order;
+	Index _index;
+
+};
+
+void TestMatch() {
+	const auto words = base::flat_set<QString>{ "builds", "team" };
+	TEST_CHECK(Dialogs::NameWordsMatch(words, { "bui" }));
+	TEST_CHECK(Dialogs::NameWordsMatch(words, { "te", "b" }));
+	TEST_CHECK(Dialogs::NameWordsMatch(words, {}));
+	TEST_CHECK(!Dialogs::NameWordsMatch(words, { "bug" }));
+	TEST_CHECK(!Dialogs::NameWordsMatch(words, { "team", "x" }));
+}
+
+void TestRenamedTopic() {
+	auto model = Model();
+	for (auto i = 0; i != 10; ++i) {
+		model.add(i, { "general" + QString::number(i) }, true);
+	}
+	model.add(100, { "bugs" }, true);
+	TEST_CHECK(model.filtered({ "bug" }) == std::vector<int>{ 100 });
+
+	model.rename(100, { "builds" });
+	TEST_CHECK(model.filtered({ "bui" }) == std::vector<int>{ 100 });
+	TEST_CHECK(model.filtered({ "bug" }).empty());
+}
+
+void TestUntrackedRename() {
+	auto model = Model();
+	for (auto i = 0; i != 10; ++i) {
+		model.add(i, { "general" + QString::number(i) }, true);
+	}
+	model.add(100, { "bugs" }, false);
+	model.rename(100, { "builds" });
+	TEST_CHECK(model.filtered({ "bui" }) == std::vector<int>{ 100 });
+	TEST_CHECK(model.filtered({ "bug" }).empty());
+}
+
+void TestShortWords() {
+	auto index = Index();
+	index.add(1, { "alpha" });
+	index.add(2, { "beta" });
+	index.add(3, { "gamma" });
+	TEST_CHECK(!index.candidates({ "a" }, 10));
+	TEST_CHECK(!index.candidates({}, 10));
+	TEST_CHECK(index.candidates({ "al" }, 10) == std::vector<int>{ 1 });
+	TEST_CHECK(index.candidates({ "alph" }, 10) == std::vector<int>{ 1 });
+	TEST_CHECK(index.candidates({ "zz" }, 10) == std::vector<int>{});
+	TEST_CHECK(!index.candidates({ "al" }, 1));
+
+	index.remove(1);
+	TEST_CHECK(index.candidates({ "al" }, 10) == std::vector<int>{});
+	index.clear();
+	TEST_CHECK(index.candidates({ "be" }, 10) == std::vector<int>{});
+}
+
+void TestRandom() {
+	auto engine = std::mt19937(20240);
+	const auto random = [&](int till) {
+		return std::uniform_int_distribution<int>(0, till - 1)(engine);
+	};
+	const auto syllables = std::vector<QString>{
+		"a", "bu", "ild", "gs", "ke", "o", "te", "am", "x", "ya", "th",
+	};
+	const auto word = [&] {
+		auto result = QString();
+		for (auto i = 0, count = 1 + random(3); i != count; ++i) {
+			result += syllables[random(syllables.size())];
+		}
+		return result;
+	};
+	const auto name = [&] {
+		auto result = QStringList();
+		for (auto i = 0, count = 1 + random(3); i != count; ++i) {
+			result.push_back(word());
+		}
+		return result;
+	};
+	const auto query = [&] {
+		auto result = QStringList();
+		for (auto i = 0, count = 1 + random(2); i != count; ++i) {
+			result.push_back(word().left(1 + random(4)));
+		}
+		return result;
+	};
+
+	auto model = Model();
+	for (auto i = 0; i != kOperationsCount; ++i) {
+		const auto key = random(kEntriesCount);
+		const auto &order = model.order();
+		const auto present = std::find(begin(order), end(order), key)
+			!= end(order);
+		switch (random(5)) {
+		case 0:
+			if (!present) {
+				model.add(key, name(), random(8) != 0);
+			}
+			break;
+		case 1:
+			if (present) {
+				model.rename(key, name());
+			}
+			break;
+		case 2:
+			if (present) {
+				model.remove(key);
+			}
+			break;
+		case 3:
+			if (present) {
+				model.moveToTop(key);
+			}
+			break;
+		case 4: {
+			const auto words = query();
+			TEST_CHECK(model.filtered(words) == model.scanned(words));
+		} break;
+		}
+	}
+}
+
+} // namespace
+
+int main() {
+	TestMatch();
+	TestRenamedTopic();
+	TestUntrackedRename();
+	TestShortWords();
+	TestRandom();
+	return Test::ChecksResult("test_dialogs_name_index");
+}
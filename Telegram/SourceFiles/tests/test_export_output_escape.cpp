@@ -0,0 +1,210 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "export/output/export_output_escape.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace Export::Output;
+
+// The character by character escaping the run based one has replaced.
+[[nodiscard]] QByteArray ReferenceJson(const QByteArray &value) {
+	const auto size = value.size();
+	const auto begin = value.data();
+	const auto end = begin + size;
+
+	auto result = QByteArray();
+	result.append('"');
+	for (auto p = begin; p != end; ++p) {
+		const auto ch = *p;
+		if (ch == '\n') {
+			result.append("\\n", 2);
+		} else if (ch == '\r') {
+			result.append("\\r", 2);
+		} else if (ch == '\t') {
+			result.append("\\t", 2);
+		} else if (ch == '"') {
+			result.append("\\\"", 2);
+		} else if (ch == '\\') {
+			result.append("\\\\", 2);
+		} else if (ch >= 0 && ch < 32) {
+			result.append("\\x", 2).append('0' + (ch >> 4));
+			const auto left = (ch & 0x0F);
+			if (left >= 10) {
+				result.append('A' + (left - 10));
+			} else {
+				result.append('0' + left);
+			}
+		} else if (ch == char(0xE2)
+			&& (p + 2 < end)
+			&& *(p + 1) == char(0x80)) {
+			if (*(p + 2) == char(0xA8)) { // Line separator.
+				result.append("\\u2028", 6);
+			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
+				result.append("\\u2029", 6);
+			} else {
+				result.append(ch);
+			}
+		} else {
+			result.append(ch);
+		}
+	}
+	result.append('"');
+	return result;
+}
+
+[[nodiscard]] QByteArray ReferenceHtml(const QByteArray &value) {
+	const auto size = value.size();
+	const auto begin = value.data();
+	const auto end = begin + size;
+
+	auto result = QByteArray();
+	for (auto p = begin; p != end; ++p) {
+		const auto ch = *p;
+		if (ch == '\n') {
+			result.append("<br>", 4);
+		} else if (ch == '"') {
+			result.append("&quot;", 6);
+		} else if (ch == '&') {
+			result.append("&amp;", 5);
+		} else if (ch == '\'') {
+			result.append("&apos;", 6);
+		} else if (ch == '<') {
+			result.append("&lt;", 4);
+		} else if (ch == '>') {
+			result.append("&gt;", 4);
+		} else if (ch >= 0 && ch < 32) {
+			result.append("&#x", 3).append('0' + (ch >> 4));
+			const auto left = (ch & 0x0F);
+			if (left >= 10) {
+				result.append('A' + (left - 10));
+			} else {
+				result.append('0' + left);
+			}
+			result.append(';');
+		} else if (ch == char(0xE2)
+			&& (p + 2 < end)
+			&& *(p + 1) == char(0x80)) {
+			if (*(p + 2) == char(0xA8)) { // Line separator.
+				result.append("<br>", 4);
+			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
+				result.append("<br>", 4);
+			} else {
+				result.append(ch);
+			}
+		} else {
+			result.append(ch);
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] bool SameAsReference(const QByteArray &value) {
+	auto appended = QByteArray("prefix");
+	AppendJsonString(appended, value);
+	return (SerializeJsonString(value) == ReferenceJson(value))
+		&& (appended == "prefix" + ReferenceJson(value))
+		&& (SerializeHtmlString(value) == ReferenceHtml(value));
+}
+
+[[nodiscard]] std::vector<QByteArray> Samples() {
+	auto result = std::vector<QByteArray>{
+		QByteArray(),
+		QByteArray("plain text without anything to escape"),
+		QByteArray("\"quoted\" and 'apostrophes'"),
+		QByteArray("<b>bold</b> & <i>italic</i>"),
+		QByteArray("back\\slash at the end\\"),
+		QByteArray("lines\nand\r\nreturns\tand tabs"),
+		QByteArray("\""),
+		QByteArray("&"),
+		QByteArray("<>"),
+		QByteArray("\n"),
+		// Emoji outside of the basic multilingual plane.
+		QByteArray("\xF0\x9F\x91\x8D thumbs \xF0\x9F\x98\x80"),
+		QByteArray("\xF0\x9F\x91\x8D"),
+		// Line and paragraph separators, other E2 80 xx characters.
+		QByteArray("a\xE2\x80\xA8" "b\xE2\x80\xA9" "c"),
+		QByteArray("dash \xE2\x80\x94 ellipsis \xE2\x80\xA6"),
+		QByteArray("cut at the end \xE2\x80"),
+		QByteArray("cut at the end \xE2"),
+		QByteArray("\xE2\x80\xA8"),
+		QByteArray("Cyrillic \xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82"),
+	};
+	auto controls = QByteArray();
+	for (auto ch = 0; ch != 32; ++ch) {
+		controls.append(char(ch));
+		result.push_back(QByteArray(1, char(ch)));
+		result.push_back("x" + QByteArray(1, char(ch)) + "y");
+	}
+	result.push_back(controls);
+	result.push_back(QByteArray(1, char(0x7F)));
+	return result;
+}
+
+void TestSamples() {
+	for (const auto &sample : Samples()) {
+		TEST_CHECK(SameAsReference(sample));
+	}
+}
+
+void TestKnownOutput() {
+	TEST_CHECK(SerializeJsonString("a\"b\\c\n") == "\"a\\\"b\\\\c\\n\"");
+	TEST_CHECK(SerializeJsonString(QByteArray(1, char(0x1F)))
+		== "\"\\x1F\"");
+	TEST_CHECK(SerializeHtmlString("<a href='x'>&</a>")
+		== "&lt;a href=&apos;x&apos;&gt;&amp;&lt;/a&gt;");
+	TEST_CHECK(SerializeHtmlString(QByteArray(1, char(0x01))) == "&#x01;");
+	TEST_CHECK(SerializeJsonString(QByteArray()) == "\"\"");
+	TEST_CHECK(SerializeHtmlString(QByteArray()).isEmpty());
+}
+
+void TestNothingToEscapeIsShared() {
+	const auto value = QByteArray("nothing to escape here");
+	const auto result = SerializeHtmlString(value);
+	TEST_CHECK(result == value);
+	TEST_CHECK(result.constData() == value.constData());
+}
+
+void TestRandom() {
+	constexpr auto kStrings = 20000;
+	constexpr auto kMaxLength = 64;
+
+	// Bytes that have special meaning are much more likely than others.
+	const auto special = QByteArray("\n\r\t\"'\\<>&\xE2\x80\xA8\xA9\xF0\x9F");
+	auto generator = std::mt19937(20240601);
+	auto mismatches = 0;
+	for (auto i = 0; i != kStrings; ++i) {
+		const auto length = int(generator() % kMaxLength);
+		auto value = QByteArray();
+		value.reserve(length);
+		for (auto j = 0; j != length; ++j) {
+			const auto random = generator();
+			value.append((random % 2)
+				? special[int((random >> 1) % special.size())]
+				: char((random >> 1) % 256));
+		}
+		if (!SameAsReference(value)) {
+			++mismatches;
+		}
+	}
+	TEST_CHECK(mismatches == 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestSamples();
+	TestKnownOutput();
+	TestNothingToEscapeIsShared();
+	TestRandom();
+	return Test::ChecksResult("test_export_output_escape");
+}
@@ -0,0 +1,351 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "history/view/history_view_deferred_resize.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto kMessages = 10000;
+constexpr auto kMessagesPerBlock = 100;
+constexpr auto kWideWidth = 720;
+constexpr auto kNarrowWidth = 480;
+constexpr auto kViewportHeight = 1000;
+
+[[nodiscard]] crl::time Now() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Text layout stand-in: the cost grows with the text length.
+struct FakeElement {
+	int length = 0;
+	int top = 0;
+	int currentHeight = 0;
+	int layoutWidth = 0;
+	bool pending = true;
+	bool deferred = false;
+
+	[[nodiscard]] int y() const {
+		return top;
+	}
+	void setY(int y) {
+		top = y;
+	}
+	[[nodiscard]] int height() const {
+		return currentHeight;
+	}
+	[[nodiscard]] bool pendingResize() const {
+		return pending;
+	}
+	[[nodiscard]] bool deferredResize() const {
+		return deferred;
+	}
+	void setDeferredResize() {
+		deferred = true;
+	}
+	int resizeGetHeight(int newWidth) {
+		auto lines = 1;
+		auto line = 0;
+		volatile auto hash = 0u;
+		for (auto i = 0; i != length; ++i) {
+			for (auto j = 0; j != 16; ++j) {
+				hash = hash * 31u + unsigned(i + j);
+			}
+			line += 7;
+			if (line > newWidth) {
+				line = 7;
+				++lines;
+			}
+		}
+		pending = deferred = false;
+		layoutWidth = newWidth;
+		currentHeight = 20 + lines * 18;
+		return currentHeight;
+	}
+};
+
+struct FakeBlock {
+	std::vector<std::unique_ptr<FakeElement>> messages;
+	int top = 0;
+	int currentHeight = 0;
+
+	[[nodiscard]] int y() const {
+		return top;
+	}
+	[[nodiscard]] int height() const {
+		return currentHeight;
+	}
+};
+
+using Blocks = std::deque<std::unique_ptr<FakeBlock>>;
+
+[[nodiscard]] Blocks GenerateHistory(int count) {
+	auto generator = std::mt19937(20241017);
+	auto lengths = std::uniform_int_distribution<int>(10, 400);
+	auto result = Blocks();
+	for (auto i = 0; i != count; ++i) {
+		if (result.empty()
+			|| result.back()->messages.size() == kMessagesPerBlock) {
+			result.push_back(std::make_unique<FakeBlock>());
+		}
+		auto element = std::make_unique<FakeElement>();
+		element->length = lengths(generator);
+		result.back()->messages.push_back(std::move(element));
+	}
+	return result;
+}
+
+// Like History::resizeToWidth() with Request::ResizeAll.
+int ResizeAll(Blocks &blocks, int newWidth, int top, int bottom) {
+	auto y = 0;
+	for (const auto &block : blocks) {
+		const auto wasTop = block->top;
+		block->top = y;
+		block->currentHeight = HistoryView::ResizeVisibleElements(
+			block->messages,
+			newWidth,
+			top - wasTop,
+			bottom - wasTop);
+		y += block->currentHeight;
+	}
+	return y;
+}
+
+// Like History::resizeToWidth() with Request::ResizePending,
+// after the deferred elements were resized in place.
+int Relayout(Blocks &blocks) {
+	auto y = 0;
+	for (const auto &block : blocks) {
+		block->top = y;
+		auto blockHeight = 0;
+		for (const auto &element : block->messages) {
+			element->setY(blockHeight);
+			blockHeight += element->height();
+		}
+		block->currentHeight = blockHeight;
+		y += blockHeight;
+	}
+	return y;
+}
+
+[[nodiscard]] int CountDeferred(const Blocks &blocks) {
+	auto result = 0;
+	for (const auto &block : blocks) {
+		for (const auto &element : block->messages) {
+			result += element->deferred ? 1 : 0;
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] double Milliseconds(
+		std::chrono::steady_clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void TestVisibleRange() {
+	auto blocks = GenerateHistory(1000);
+	const auto full = ResizeAll(blocks, kWideWidth, 0, 0x7FFFFFFF);
+
+	// A new element outside of the range can't keep a height estimate.
+	auto &pending = blocks.front()->messages.front();
+	pending->pending = true;
+
+	const auto top = full / 2;
+	const auto bottom = top + kViewportHeight;
+	const auto estimated = ResizeAll(blocks, kNarrowWidth, top, bottom);
+	TEST_CHECK(pending->layoutWidth == kNarrowWidth);
+	TEST_CHECK(!pending->deferred);
+
+	auto wrongWidth = 0;
+	auto resizedInRange = 0;
+	for (const auto &block : blocks) {
+		for (const auto &element : block->messages) {
+			if (element->deferred) {
+				wrongWidth += (element->layoutWidth == kWideWidth) ? 0 : 1;
+			} else {
+				wrongWidth += (element->layoutWidth == kNarrowWidth) ? 0 : 1;
+				++resizedInRange;
+			}
+		}
+	}
+	TEST_CHECK(wrongWidth == 0);
+	TEST_CHECK(resizedInRange > 1);
+	TEST_CHECK(resizedInRange < 200);
+
+	// The positions are recounted with the estimated heights.
+	TEST_CHECK(Relayout(blocks) == estimated);
+
+	// Elements that came into view are found and only them are resized.
+	const auto viewTop = estimated / 4;
+	const auto viewBottom = viewTop + kViewportHeight;
+	auto found = 0;
+	const auto any = HistoryView::EnumerateDeferredElements(
+		blocks,
+		viewTop,
+		viewBottom,
+		[&](FakeElement *element) {
+			element->resizeGetHeight(kNarrowWidth);
+			++found;
+			return true;
+		});
+	TEST_CHECK(any);
+	TEST_CHECK(found > 0);
+	TEST_CHECK(!HistoryView::EnumerateDeferredElements(
+		blocks,
+		viewTop,
+		viewBottom,
+		[](FakeElement*) { return false; }));
+	TEST_CHECK(HistoryView::EnumerateDeferredElements(
+		blocks,
+		0,
+		kViewportHeight,
+		[](FakeElement*) { return false; }));
+}
+
+void TestChunks() {
+	auto blocks = GenerateHistory(1000);
+	const auto full = ResizeAll(blocks, kWideWidth, 0, 0x7FFFFFFF);
+	ResizeAll(blocks, kNarrowWidth, full - kViewportHeight, full);
+	const auto deferred = CountDeferred(blocks);
+	TEST_CHECK(deferred > 900);
+
+	// A fake clock ticking once per check, which is done before
+	// each element but the first one.
+	auto ticks = crl::time(0);
+	const auto now = [&] { return ticks++; };
+	const auto chunk = HistoryView::ResizeDeferredElements(
+		blocks,
+		kNarrowWidth,
+		crl::time(99),
+		now);
+	TEST_CHECK(!chunk.finished);
+	TEST_CHECK(chunk.resized == 100);
+	TEST_CHECK(CountDeferred(blocks) == deferred - 100);
+
+	// The bottom, which is the usual scroll position, goes first.
+	auto lastDeferred = -1;
+	auto firstResized = -1;
+	auto index = 0;
+	for (const auto &block : blocks) {
+		for (const auto &element : block->messages) {
+			if (element->deferred) {
+				lastDeferred = index;
+			} else if (firstResized < 0) {
+				firstResized = index;
+			}
+			++index;
+		}
+	}
+	TEST_CHECK(lastDeferred < firstResized);
+
+	// An expired deadline still lets each chunk make progress.
+	const auto expired = HistoryView::ResizeDeferredElements(
+		blocks,
+		kNarrowWidth,
+		crl::time(0),
+		now);
+	TEST_CHECK(expired.resized == 1);
+	TEST_CHECK(!expired.finished);
+
+	const auto rest = HistoryView::ResizeDeferredElements(
+		blocks,
+		kNarrowWidth,
+		std::numeric_limits<crl::time>::max(),
+		now);
+	TEST_CHECK(rest.finished);
+	TEST_CHECK(rest.resized == deferred - 101);
+	TEST_CHECK(CountDeferred(blocks) == 0);
+}
+
+void BenchmarkResize() {
+	constexpr auto kChunkDuration = crl::time(8);
+
+	auto reference = GenerateHistory(kMessages);
+	ResizeAll(reference, kWideWidth, 0, 0x7FFFFFFF);
+	auto blocks = GenerateHistory(kMessages);
+	const auto full = ResizeAll(blocks, kWideWidth, 0, 0x7FFFFFFF);
+
+	// The old way: every element is laid out before the next frame.
+	auto start = std::chrono::steady_clock::now();
+	const auto expected = ResizeAll(reference, kNarrowWidth, 0, 0x7FFFFFFF);
+	const auto fullMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+	// The visible range first, the rest in idle chunks.
+	start = std::chrono::steady_clock::now();
+	ResizeAll(blocks, kNarrowWidth, full - kViewportHeight, full);
+	const auto visibleMs = Milliseconds(
+		std::chrono::steady_clock::now() - start);
+
+	auto chunks = 0;
+	auto longestChunkMs = 0.;
+	start = std::chrono::steady_clock::now();
+	while (true) {
+		const auto chunkStart = std::chrono::steady_clock::now();
+		const auto chunk = HistoryView::ResizeDeferredElements(
+			blocks,
+			kNarrowWidth,
+			Now() + kChunkDuration,
+			Now);
+		Relayout(blocks);
+		longestChunkMs = std::max(
+			longestChunkMs,
+			Milliseconds(std::chrono::steady_clock::now() - chunkStart));
+		++chunks;
+		if (chunk.finished) {
+			break;
+		}
+	}
+	const auto chunksMs = Milliseconds(
+		std::chrono::steady_clock::now() - start);
+
+	std::printf(
+		"%d messages: full resize %.3f ms, visible range %.3f ms, "
+		"%d idle chunks in %.3f ms, longest %.3f ms\n",
+		kMessages,
+		fullMs,
+		visibleMs,
+		chunks,
+		chunksMs,
+		longestChunkMs);
+
+	// When the chunks are done the layout is the same as the full one.
+	TEST_CHECK(Relayout(blocks) == expected);
+	auto mismatches = 0;
+	for (auto b = 0; b != int(blocks.size()); ++b) {
+		const auto &elements = blocks[b]->messages;
+		const auto &expectedElements = reference[b]->messages;
+		for (auto e = 0; e != int(elements.size()); ++e) {
+			if (elements[e]->y() != expectedElements[e]->y()
+				|| elements[e]->height() != expectedElements[e]->height()) {
+				++mismatches;
+			}
+		}
+	}
+	TEST_CHECK(mismatches == 0);
+	TEST_CHECK(CountDeferred(blocks) == 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestVisibleRange();
+	TestChunks();
+	BenchmarkResize();
+	return Test::ChecksResult("test_history_view_deferred_resize");
+}
@@ -0,0 +1,177 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "statistics/view/linear_chart_decimation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct FakePoint {
+	double px = 0.;
+	double py = 0.;
+
+	[[nodiscard]] double x() const {
+		return px;
+	}
+	[[nodiscard]] double y() const {
+		return py;
+	}
+
+	friend inline bool operator==(
+		const FakePoint &,
+		const FakePoint &) = default;
+};
+
+using Points = std::vector<FakePoint>;
+
+constexpr auto kWidth = 600;
+
+// A noisy series, like the ones in large channel statistics.
+[[nodiscard]] Points GenerateSeries(int count) {
+	auto generator = std::mt19937(20240705);
+	auto noise = std::normal_distribution<double>(0., 20.);
+	auto result = Points();
+	result.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		const auto x = kWidth * (i / double(count - 1));
+		const auto y = 200. + 100. * std::sin(i / 5000.) + noise(generator);
+		result.push_back({ x, y });
+	}
+	return result;
+}
+
+[[nodiscard]] Points Decimate(const Points &series) {
+	auto result = Points();
+	auto decimation = Statistic::LinearChartDecimation<Points>(result);
+	for (const auto &point : series) {
+		decimation.add(point);
+	}
+	decimation.finish();
+	return result;
+}
+
+struct ColumnRange {
+	double top = 0.;
+	double bottom = 0.;
+	FakePoint first;
+	FakePoint last;
+};
+
+[[nodiscard]] std::map<int, ColumnRange> Columns(const Points &points) {
+	auto result = std::map<int, ColumnRange>();
+	for (const auto &point : points) {
+		const auto x = int(std::floor(point.x()));
+		const auto i = result.find(x);
+		if (i == end(result)) {
+			result.emplace(x, ColumnRange{
+				point.y(),
+				point.y(),
+				point,
+				point,
+			});
+		} else {
+			i->second.top = std::min(i->second.top, point.y());
+			i->second.bottom = std::max(i->second.bottom, point.y());
+			i->second.last = point;
+		}
+	}
+	return result;
+}
+
+void TestSmallColumns() {
+	// One point in a column stays as is.
+	TEST_CHECK(Decimate({ { 0.5, 1. } }) == (Points{ { 0.5, 1. } }));
+
+	// Top and bottom are kept in their original order.
+	const auto series = Points{
+		{ 0.1, 5. },
+		{ 0.2, 9. },
+		{ 0.3, 1. },
+		{ 0.4, 4. },
+		{ 0.5, 6. },
+		{ 1.5, 3. },
+	};
+	TEST_CHECK(Decimate(series) == (Points{
+		{ 0.1, 5. },
+		{ 0.2, 9. },
+		{ 0.3, 1. },
+		{ 0.5, 6. },
+		{ 1.5, 3. },
+	}));
+
+	// The first and the last points are not repeated as top or bottom.
+	const auto edges = Points{ { 0.1, 1. }, { 0.2, 5. }, { 0.3, 9. } };
+	TEST_CHECK(Decimate(edges) == (Points{ { 0.1, 1. }, { 0.3, 9. } }));
+}
+
+void TestSameColumnsAsSeries() {
+	constexpr auto kPoints = 100000;
+	constexpr auto kRounds = 20;
+
+	const auto series = GenerateSeries(kPoints);
+
+	auto decimated = Points();
+	const auto start = std::chrono::steady_clock::now();
+	for (auto i = 0; i != kRounds; ++i) {
+		decimated = Decimate(series);
+	}
+	const auto duration = std::chrono::steady_clock::now() - start;
+	const auto ms = std::chrono::duration<double, std::milli>(
+		duration).count() / kRounds;
+	std::printf(
+		"%d points in %d columns: %d points left, %.3f ms per paint\n",
+		kPoints,
+		kWidth,
+		int(decimated.size()),
+		ms);
+
+	// At most four points per column, the polyline is stroked
+	// with about the same cost whatever the series length is.
+	TEST_CHECK(decimated.size() <= 4 * (kWidth + 1));
+
+	// Each column covers the same pixels as with all the points.
+	const auto all = Columns(series);
+	const auto kept = Columns(decimated);
+	auto mismatches = 0;
+	for (const auto &[x, range] : all) {
+		const auto i = kept.find(x);
+		if (i == end(kept)
+			|| i->second.top != range.top
+			|| i->second.bottom != range.bottom
+			|| !(i->second.first == range.first)
+			|| !(i->second.last == range.last)) {
+			++mismatches;
+		}
+	}
+	TEST_CHECK(all.size() == kept.size());
+	TEST_CHECK(mismatches == 0);
+
+	// The original order is kept.
+	TEST_CHECK(std::is_sorted(
+		begin(decimated),
+		end(decimated),
+		[](const FakePoint &a, const FakePoint &b) {
+			return a.x() < b.x();
+		}));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestSmallColumns();
+	TestSameColumnsAsSeries();
+	return Test::ChecksResult("test_linear_chart_decimation");
+}
@@ -0,0 +1,164 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "ffmpeg/ffmpeg_premultiply.h"
+#include "ui/chat/chat_theme_pixels.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto kRandomImagesCount = 200;
+
+// The loops the rewritten ones have replaced.
+void ReferencePremultiply(uint *dst, const uint *src, int count) {
+	for (auto i = 0; i != count; ++i) {
+		dst[i] = qPremultiply(src[i]);
+	}
+}
+
+[[nodiscard]] Ui::ColorComponentsSum ReferenceSum(
+		const uchar *pix,
+		int size) {
+	uint64 components[3] = { 0 };
+	for (auto i = 0, l = size * 4; i != l; i += 4) {
+		components[2] += pix[i + 0];
+		components[1] += pix[i + 1];
+		components[0] += pix[i + 2];
+	}
+	return { components[0], components[1], components[2] };
+}
+
+[[nodiscard]] bool LittleEndian() {
+	const auto value = uint32(1);
+	auto first = uchar();
+	std::memcpy(&first, &value, 1);
+	return (first == 1);
+}
+
+[[nodiscard]] bool Equal(
+		const Ui::ColorComponentsSum &a,
+		const Ui::ColorComponentsSum &b) {
+	return (a.red == b.red) && (a.green == b.green) && (a.blue == b.blue);
+}
+
+void TestPremultiplyAllAlphas() {
+	auto engine = std::mt19937(1);
+	auto src = std::vector<uint>();
+	for (auto alpha = 0; alpha != 256; ++alpha) {
+		for (auto i = 0; i != 64; ++i) {
+			src.push_back((uint(alpha) << 24) | (engine() & 0xFFFFFFU));
+		}
+		src.push_back(uint(alpha) << 24);
+		src.push_back((uint(alpha) << 24) | 0xFFFFFFU);
+	}
+	const auto count = int(src.size());
+	auto fast = std::vector<uint>(count, 0xDEADBEEFU);
+	auto reference = std::vector<uint>(count, 0xDEADBEEFU);
+	FFmpeg::PremultiplyPixels(fast.data(), src.data(), count);
+	ReferencePremultiply(reference.data(), src.data(), count);
+	TEST_CHECK(fast == reference);
+}
+
+void TestPremultiplyInPlace() {
+	auto engine = std::mt19937(2);
+	auto pixels = std::vector<uint>(1000);
+	for (auto &pixel : pixels) {
+		pixel = engine();
+	}
+	auto reference = std::vector<uint>(pixels.size());
+	ReferencePremultiply(reference.data(), pixels.data(), pixels.size());
+	FFmpeg::PremultiplyPixels(pixels.data(), pixels.data(), pixels.size());
+	TEST_CHECK(pixels == reference);
+}
+
+void TestSumPacked() {
+	if (!LittleEndian()) {
+		// The byte order reference loop is only right on little endian.
+		return;
+	}
+	auto engine = std::mt19937(3);
+	for (auto i = 0; i != kRandomImagesCount; ++i) {
+		const auto width = int(engine() % 300);
+		const auto height = int(engine() % 300);
+		auto pixels = std::vector<uint32>(width * height);
+		for (auto &pixel : pixels) {
+			pixel = engine();
+		}
+		const auto bits = reinterpret_cast<const uchar*>(pixels.data());
+		TEST_CHECK(Equal(
+			Ui::SumColorComponents(bits, width, height, width * 4),
+			ReferenceSum(bits, width * height)));
+	}
+}
+
+void TestSumPadded() {
+	auto engine = std::mt19937(4);
+	for (auto i = 0; i != kRandomImagesCount; ++i) {
+		const auto width = 1 + int(engine() % 300);
+		const auto height = 1 + int(engine() % 300);
+		const auto padding = 1 + int(engine() % 16);
+		const auto stride = width + padding;
+
+		// The padding is filled with pixels that must not be counted.
+		auto packed = std::vector<uint32>(width * height);
+		auto padded = std::vector<uint32>(stride * height, 0xFFFFFFFFU);
+		for (auto y = 0; y != height; ++y) {
+			for (auto x = 0; x != width; ++x) {
+				const auto pixel = uint32(engine());
+				packed[y * width + x] = pixel;
+				padded[y * stride + x] = pixel;
+			}
+		}
+		TEST_CHECK(Equal(
+			Ui::SumColorComponents(
+				reinterpret_cast<const uchar*>(padded.data()),
+				width,
+				height,
+				stride * 4),
+			Ui::SumColorComponents(
+				reinterpret_cast<const uchar*>(packed.data()),
+				width,
+				height,
+				width * 4)));
+	}
+}
+
+void TestSumWhite() {
+	const auto width = 4096;
+	const auto height = 4096;
+	auto line = std::vector<uint32>(width, 0xFFFFFFFFU);
+	auto pixels = std::vector<uint32>();
+	pixels.reserve(width * height);
+	for (auto y = 0; y != height; ++y) {
+		pixels.insert(end(pixels), begin(line), end(line));
+	}
+	const auto sum = Ui::SumColorComponents(
+		reinterpret_cast<const uchar*>(pixels.data()),
+		width,
+		height,
+		width * 4);
+	const auto expected = uint64(255) * width * height;
+	TEST_CHECK(sum.red == expected);
+	TEST_CHECK(sum.green == expected);
+	TEST_CHECK(sum.blue == expected);
+}
+
+} // namespace
+
+int main() {
+	TestPremultiplyAllAlphas();
+	TestPremultiplyInPlace();
+	TestSumPacked();
+	TestSumPadded();
+	TestSumWhite();
+	return Test::ChecksResult("test_pixel_loops");
+}
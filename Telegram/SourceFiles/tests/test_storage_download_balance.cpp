@@ -0,0 +1,156 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "storage/details/storage_download_balance.h"
+
+#include <deque>
+
+namespace {
+
+using namespace Storage;
+using namespace Storage::details;
+
+constexpr auto kSimulateDuration = 30 * crl::time(1000);
+
+// Less than kMinRttExpiresTimeout, so the minimal rtt stays measured
+// on the first requests, before anything has queued.
+constexpr auto kSimulateQueueingDuration = 8 * crl::time(1000);
+
+// One session over a link with a fixed bandwidth and round trip time.
+// Parts are served one after another, so the request durations grow
+// as soon as more is in flight than the bandwidth-delay product.
+struct Link {
+	int64 bandwidth = 0; // Bytes per second.
+	crl::time rtt = 0;
+};
+
+struct Result {
+	DownloadSessionBalance session;
+	int completed = 0;
+	int maxRequested = 0;
+};
+
+[[nodiscard]] Result Simulate(
+		Link link,
+		int partSize,
+		crl::time duration = kSimulateDuration) {
+	struct Request {
+		int64 sent = 0; // All times are in microseconds.
+		int64 arrives = 0;
+		int amountAtStart = 0;
+	};
+	auto result = Result();
+	auto &session = result.session;
+	auto requests = std::deque<Request>();
+	const auto halfRtt = link.rtt * 1000 / 2;
+	const auto serve = int64(partSize) * 1000'000 / link.bandwidth;
+	auto now = int64(0);
+	auto linkFree = int64(0);
+	while (now < duration * 1000) {
+		while (session.fits(partSize)) {
+			session.requested += partSize;
+			++session.requests;
+			result.maxRequested = std::max(
+				result.maxRequested,
+				session.requested);
+			linkFree = std::max(now + halfRtt, linkFree) + serve;
+			requests.push_back({
+				.sent = now,
+				.arrives = linkFree + halfRtt,
+				.amountAtStart = session.requested,
+			});
+		}
+		const auto request = requests.front();
+		requests.pop_front();
+		now = request.arrives;
+		session.requested -= partSize;
+		--session.requests;
+		session.feedSample(
+			now / 1000,
+			(request.arrives - request.sent) / 1000,
+			request.amountAtStart);
+		session.updateWaitedAmount(request.amountAtStart, partSize);
+		++result.completed;
+	}
+	return result;
+}
+
+void TestFastLinkSmallParts() {
+	const auto link = Link{ .bandwidth = 100 * 1024 * 1024, .rtt = 200 };
+	const auto result = Simulate(link, kDownloadPartSize);
+	const auto &session = result.session;
+
+	// Sixteen requests never fill kMaxWaitedInSession with small parts,
+	// the window must still count as limited to let sessions be added.
+	TEST_CHECK(!session.queueing());
+	TEST_CHECK(session.maxWaitedAmount < kMaxWaitedInSession);
+	TEST_CHECK(session.maxWaitedAmount
+		>= MaxWaitedInSession(kDownloadPartSize));
+	TEST_CHECK(session.limited(kDownloadPartSize));
+	TEST_CHECK(result.maxRequested
+		== kMaxRequestsInSession * kDownloadPartSize);
+}
+
+void TestFastLinkLargeParts() {
+	const auto link = Link{ .bandwidth = 100 * 1024 * 1024, .rtt = 200 };
+	const auto result = Simulate(link, kMaxDownloadPartSize);
+	const auto &session = result.session;
+
+	TEST_CHECK(!session.queueing());
+	TEST_CHECK(session.maxWaitedAmount == kMaxWaitedInSession);
+	TEST_CHECK(session.limited(kMaxDownloadPartSize));
+	TEST_CHECK(result.maxRequested == kMaxWaitedInSession);
+}
+
+void TestSlowLink() {
+	const auto link = Link{ .bandwidth = 512 * 1024, .rtt = 50 };
+	const auto result = Simulate(
+		link,
+		kDownloadPartSize,
+		kSimulateQueueingDuration);
+	const auto &session = result.session;
+
+	// Requests queue at the bottleneck, the window stays small.
+	TEST_CHECK(session.queueing());
+	TEST_CHECK(session.limited(kDownloadPartSize));
+	TEST_CHECK(session.maxWaitedAmount < 2 * kStartWaitedInSession);
+	TEST_CHECK(session.bandwidth > 0);
+	TEST_CHECK(session.bandwidth <= link.bandwidth);
+}
+
+void TestDeterministic() {
+	const auto link = Link{ .bandwidth = 8 * 1024 * 1024, .rtt = 120 };
+	const auto first = Simulate(link, kDownloadPartSize);
+	const auto second = Simulate(link, kDownloadPartSize);
+	TEST_CHECK(first.completed == second.completed);
+	TEST_CHECK(first.session.maxWaitedAmount
+		== second.session.maxWaitedAmount);
+	TEST_CHECK(first.session.bandwidth == second.session.bandwidth);
+	TEST_CHECK(first.session.smoothedRtt == second.session.smoothedRtt);
+}
+
+void TestSinglePartAlwaysFits() {
+	auto session = DownloadSessionBalance();
+	TEST_CHECK(session.fits(kMaxDownloadPartSize));
+	session.requested = kMaxDownloadPartSize;
+	session.requests = 1;
+	TEST_CHECK(!session.fits(kMaxDownloadPartSize));
+	TEST_CHECK(session.maxWaitedAmount == kStartWaitedInSession);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestFastLinkSmallParts();
+	TestFastLinkLargeParts();
+	TestSlowLink();
+	TestDeterministic();
+	TestSinglePartAlwaysFits();
+	return Test::ChecksResult("test_storage_download_balance");
+}
@@ -0,0 +1,395 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "storage/details/storage_download_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct FakeTask {
+	[[nodiscard]] bool readyToRequest() const {
+		return ready;
+	}
+	[[nodiscard]] int partSize() const {
+		return size;
+	}
+	void removeSession(int index) {
+		removedSessions.push_back(index);
+	}
+
+	int id = 0;
+	int size = 128;
+	bool ready = true;
+	std::vector<int> removedSessions;
+};
+
+using Queue = Storage::details::DownloadQueue<FakeTask>;
+
+// The vector based queue the map based one has replaced.
+class ReferenceQueue final {
+public:
+	void enqueue(not_null<FakeTask*> task, int priority) {
+		const auto position = std::find_if(
+			begin(_tasks),
+			end(_tasks),
+			[&](const Enqueued &enqueued) {
+				return enqueued.priority <= priority;
+			}) - begin(_tasks);
+		auto i = std::find_if(
+			begin(_tasks),
+			end(_tasks),
+			[&](const Enqueued &enqueued) { return enqueued.task == task; });
+		if (i != end(_tasks)) {
+			i->priority = priority;
+		} else {
+			_tasks.push_back({ task, priority });
+			i = end(_tasks) - 1;
+		}
+		const auto j = begin(_tasks) + position;
+		if (j < i) {
+			std::rotate(j, i, i + 1);
+		} else if (j > i + 1) {
+			std::rotate(i, i + 1, j);
+		}
+	}
+	void remove(not_null<FakeTask*> task) {
+		_tasks.erase(std::remove_if(
+			begin(_tasks),
+			end(_tasks),
+			[&](const Enqueued &enqueued) { return enqueued.task == task; }
+		), end(_tasks));
+	}
+	void resetGeneration() {
+		for (auto &enqueued : _tasks) {
+			if (!enqueued.priority) {
+				enqueued.priority = -1;
+			}
+		}
+	}
+	template <typename Fits>
+	[[nodiscard]] FakeTask *nextTask(
+			bool onlyHighestPriority,
+			Fits &&fits) const {
+		if (_tasks.empty()) {
+			return nullptr;
+		}
+		const auto highestPriority = _tasks.front().priority;
+		for (const auto &enqueued : _tasks) {
+			if (onlyHighestPriority
+				&& highestPriority > 0
+				&& enqueued.priority != highestPriority) {
+				break;
+			} else if (enqueued.task->readyToRequest()
+				&& fits(enqueued.task)) {
+				return enqueued.task;
+			}
+		}
+		return nullptr;
+	}
+	[[nodiscard]] std::vector<int> order() const {
+		auto result = std::vector<int>();
+		for (const auto &enqueued : _tasks) {
+			result.push_back(enqueued.task->id);
+		}
+		return result;
+	}
+
+private:
+	struct Enqueued {
+		not_null<FakeTask*> task;
+		int priority = 0;
+	};
+	std::vector<Enqueued> _tasks;
+
+};
+
+[[nodiscard]] std::vector<int> Order(const Queue &queue) {
+	auto result = std::vector<int>();
+	queue.enumerate([&](not_null<FakeTask*> task) {
+		result.push_back(task->id);
+	});
+	return result;
+}
+
+[[nodiscard]] std::vector<FakeTask> MakeTasks(int count) {
+	auto result = std::vector<FakeTask>(count);
+	for (auto i = 0; i != count; ++i) {
+		result[i].id = i;
+	}
+	return result;
+}
+
+[[nodiscard]] bool Any(not_null<FakeTask*> task) {
+	return true;
+}
+
+void TestInsertOrder() {
+	auto tasks = MakeTasks(3);
+	auto queue = Queue();
+	TEST_CHECK(queue.empty());
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 0);
+	queue.enqueue(&tasks[2], 1);
+	TEST_CHECK(queue.size() == 3);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 1, 0 }));
+}
+
+void TestReprioritize() {
+	auto tasks = MakeTasks(3);
+	auto queue = Queue();
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 0);
+	queue.enqueue(&tasks[2], 1);
+
+	queue.enqueue(&tasks[0], 2);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 0, 2, 1 }));
+
+	// Enqueued again with the same priority it goes first inside it.
+	queue.enqueue(&tasks[1], 0);
+	queue.enqueue(&tasks[2], 2);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 0, 1 }));
+	TEST_CHECK(queue.size() == 3);
+}
+
+void TestRemove() {
+	auto tasks = MakeTasks(3);
+	auto queue = Queue();
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 1);
+	queue.enqueue(&tasks[2], 0);
+
+	queue.remove(&tasks[1]);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 0 }));
+	queue.remove(&tasks[1]);
+	TEST_CHECK(queue.size() == 2);
+	queue.remove(&tasks[2]);
+	queue.remove(&tasks[0]);
+	TEST_CHECK(queue.empty());
+	TEST_CHECK(queue.nextTask(false, Any) == nullptr);
+}
+
+void TestResetGeneration() {
+	auto tasks = MakeTasks(5);
+	auto queue = Queue();
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 0);
+	queue.enqueue(&tasks[2], 1);
+	queue.resetGeneration();
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 1, 0 }));
+
+	// Tasks enqueued after the reset go before the reset ones.
+	queue.enqueue(&tasks[3], 0);
+	queue.enqueue(&tasks[4], 0);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 4, 3, 1, 0 }));
+	queue.resetGeneration();
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 4, 3, 1, 0 }));
+
+	queue.enqueue(&tasks[0], 0);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 2, 0, 4, 3, 1 }));
+}
+
+void TestNextTask() {
+	auto tasks = MakeTasks(4);
+	tasks[1].size = 256;
+	tasks[2].size = 512;
+	auto queue = Queue();
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 1);
+	queue.enqueue(&tasks[2], 2);
+	queue.enqueue(&tasks[3], 2);
+
+	TEST_CHECK(queue.nextTask(true, Any) == &tasks[3]);
+	tasks[3].ready = false;
+	TEST_CHECK(queue.nextTask(true, Any) == &tasks[2]);
+
+	// Only the highest priority is allowed while something is requested.
+	const auto notTwo = [&](not_null<FakeTask*> task) {
+		return (task->partSize() != tasks[2].size);
+	};
+	TEST_CHECK(queue.nextTask(true, notTwo) == nullptr);
+	TEST_CHECK(queue.nextTask(false, notTwo) == &tasks[1]);
+
+	// Tasks that don't fit are skipped, not blocking the ones after.
+	const auto onlyZero = [&](not_null<FakeTask*> task) {
+		return (task->partSize() == tasks[0].size);
+	};
+	TEST_CHECK(queue.nextTask(false, onlyZero) == &tasks[0]);
+
+	// Zero priority never limits the search to the first priority.
+	auto zeros = MakeTasks(2);
+	auto other = Queue();
+	other.enqueue(&zeros[0], 0);
+	other.enqueue(&zeros[1], -1);
+	zeros[0].ready = false;
+	TEST_CHECK(other.nextTask(true, Any) == &zeros[1]);
+
+	// A task found not ready is skipped until it is unparked.
+	tasks[3].ready = true;
+	TEST_CHECK(queue.nextTask(true, Any) == &tasks[2]);
+	queue.unpark(&tasks[3]);
+	TEST_CHECK(queue.nextTask(true, Any) == &tasks[3]);
+	TEST_CHECK(queue.size() == 4);
+	TEST_CHECK(Order(queue) == (std::vector<int>{ 3, 2, 1, 0 }));
+}
+
+void TestNextTaskPartSizes() {
+	auto tasks = MakeTasks(4);
+	tasks[0].size = 512;
+	tasks[1].size = 128;
+	tasks[2].size = 512;
+	tasks[3].size = 1024;
+	auto queue = Queue();
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 0);
+	queue.enqueue(&tasks[2], 0);
+	queue.enqueue(&tasks[3], 0);
+	TEST_CHECK(queue.nextTask(true, Any) == &tasks[3]);
+
+	const auto smallerThan = [](int size) {
+		return [=](not_null<FakeTask*> task) {
+			return (task->partSize() < size);
+		};
+	};
+	TEST_CHECK(queue.nextTask(true, smallerThan(1024)) == &tasks[2]);
+	TEST_CHECK(queue.nextTask(true, smallerThan(512)) == &tasks[1]);
+	TEST_CHECK(queue.nextTask(true, smallerThan(128)) == nullptr);
+
+	tasks[2].ready = false;
+	TEST_CHECK(queue.nextTask(true, smallerThan(1024)) == &tasks[1]);
+	queue.remove(&tasks[1]);
+	TEST_CHECK(queue.nextTask(true, smallerThan(1024)) == &tasks[0]);
+
+	// A higher priority not ready task still limits the search.
+	queue.enqueue(&tasks[2], 1);
+	tasks[2].ready = false;
+	TEST_CHECK(queue.nextTask(true, Any) == nullptr);
+	TEST_CHECK(queue.nextTask(false, Any) == &tasks[3]);
+}
+
+void TestRemoveSession() {
+	auto tasks = MakeTasks(2);
+	auto queue = Queue();
+	queue.enqueue(&tasks[0], 0);
+	queue.enqueue(&tasks[1], 1);
+	queue.removeSession(3);
+	TEST_CHECK(tasks[0].removedSessions == (std::vector<int>{ 3 }));
+	TEST_CHECK(tasks[1].removedSessions == (std::vector<int>{ 3 }));
+}
+
+void TestSameOrderAsReference() {
+	constexpr auto kTasks = 32;
+	constexpr auto kOperations = 20000;
+
+	auto tasks = MakeTasks(kTasks);
+	auto queue = Queue();
+	auto reference = ReferenceQueue();
+	auto generator = std::mt19937(20240601);
+	auto random = [&](int till) {
+		return int(generator() % till);
+	};
+	auto mismatches = 0;
+	for (auto i = 0; i != kOperations; ++i) {
+		const auto task = &tasks[random(kTasks)];
+		const auto operation = random(14);
+		if (operation < 6) {
+			const auto priority = random(4);
+			queue.enqueue(task, priority);
+			reference.enqueue(task, priority);
+		} else if (operation < 9) {
+			queue.remove(task);
+			reference.remove(task);
+		} else if (operation < 10) {
+			queue.resetGeneration();
+			reference.resetGeneration();
+		} else if (operation < 12) {
+			task->ready = !task->ready;
+			if (task->ready) {
+				queue.unpark(task);
+			}
+		} else {
+			const auto limit = 128 << random(4);
+			const auto fits = [&](not_null<FakeTask*> candidate) {
+				return (candidate->partSize() <= limit);
+			};
+			const auto onlyHighestPriority = (random(2) == 1);
+			if (queue.nextTask(onlyHighestPriority, fits)
+				!= reference.nextTask(onlyHighestPriority, fits)) {
+				++mismatches;
+			}
+		}
+		if (Order(queue) != reference.order()) {
+			++mismatches;
+		}
+	}
+	TEST_CHECK(mismatches == 0);
+}
+
+template <typename Queue>
+[[nodiscard]] double MeasureNextTask(
+		Queue &queue,
+		std::vector<FakeTask> &tasks,
+		int rounds) {
+	const auto start = std::chrono::steady_clock::now();
+	for (auto i = 0; i != rounds; ++i) {
+		// The last enqueued task is requested and stops being ready,
+		// like a streaming loader waiting for the parts it has sent.
+		const auto task = queue.nextTask(true, Any);
+		if (task) {
+			task->ready = false;
+		}
+	}
+	const auto duration = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void BenchmarkNextTask() {
+	constexpr auto kTasks = 10000;
+	constexpr auto kRounds = 5000;
+	constexpr auto kPartSizes = 4;
+
+	auto tasks = MakeTasks(kTasks);
+	auto queue = Queue();
+	auto reference = ReferenceQueue();
+	for (auto &task : tasks) {
+		task.size = 128 << (task.id % kPartSizes);
+		queue.enqueue(&task, 0);
+		reference.enqueue(&task, 0);
+	}
+	const auto queueTime = MeasureNextTask(queue, tasks, kRounds);
+	for (auto &task : tasks) {
+		task.ready = true;
+	}
+	const auto referenceTime = MeasureNextTask(reference, tasks, kRounds);
+	std::printf(
+		"nextTask, %d tasks, %d calls: %.2f ms, linear walk: %.2f ms\n",
+		kTasks,
+		kRounds,
+		queueTime,
+		referenceTime);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestInsertOrder();
+	TestReprioritize();
+	TestRemove();
+	TestResetGeneration();
+	TestNextTask();
+	TestNextTaskPartSizes();
+	TestRemoveSession();
+	TestSameOrderAsReference();
+	BenchmarkNextTask();
+	return Test::ChecksResult("test_storage_download_queue");
+}
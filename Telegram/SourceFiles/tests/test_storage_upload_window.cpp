@@ -0,0 +1,162 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "tests/test_checks.h"
+
+#include "storage/details/storage_upload_window.h"
+
+#include <deque>
+
+namespace {
+
+using namespace Storage::details;
+
+constexpr auto kSimulateDuration = 60 * crl::time(1000);
+constexpr auto kFastRequestThreshold = 1 * crl::time(1000);
+constexpr auto kBigFilePartSize = 512 * 1024;
+
+// One session over a link with a fixed bandwidth and round trip time,
+// parts are sent one after another while the window allows that.
+struct Link {
+	int64 bandwidth = 0; // Bytes per second.
+	crl::time rtt = 0;
+};
+
+struct Result {
+	UploadSessionWindow window;
+	int64 uploaded = 0;
+	int minWindow = 0;
+	int maxWindow = 0;
+	int maxSent = 0;
+};
+
+[[nodiscard]] Result Simulate(Link link, int partSize) {
+	struct Request {
+		int64 sent = 0; // All times are in microseconds.
+		int64 arrives = 0;
+	};
+	auto result = Result();
+	auto &window = result.window;
+	result.minWindow = result.maxWindow = window.size;
+	auto requests = std::deque<Request>();
+	const auto halfRtt = link.rtt * 1000 / 2;
+	const auto serve = int64(partSize) * 1000'000 / link.bandwidth;
+	auto now = int64(0);
+	auto linkFree = int64(0);
+	auto sent = 0;
+	while (now < kSimulateDuration * 1000) {
+		while (!window.full(sent, partSize)) {
+			sent += partSize;
+			result.maxSent = std::max(result.maxSent, sent);
+			linkFree = std::max(now + halfRtt, linkFree) + serve;
+			requests.push_back({
+				.sent = now,
+				.arrives = linkFree + halfRtt,
+			});
+		}
+		const auto request = requests.front();
+		requests.pop_front();
+		now = request.arrives;
+		sent -= partSize;
+		const auto duration = (request.arrives - request.sent) / 1000;
+		window.requestDone(
+			request.sent / 1000,
+			now / 1000,
+			partSize,
+			(duration < kFastRequestThreshold));
+		result.uploaded += partSize;
+		result.minWindow = std::min(result.minWindow, window.size);
+		result.maxWindow = std::max(result.maxWindow, window.size);
+	}
+	return result;
+}
+
+[[nodiscard]] int64 Throughput(const Result &result) {
+	return result.uploaded * 1000 / kSimulateDuration;
+}
+
+void TestFastLink() {
+	const auto link = Link{ .bandwidth = 50 * 1024 * 1024, .rtt = 200 };
+	const auto result = Simulate(link, kBigFilePartSize);
+
+	// Requests stay fast, the window grows to the limit and stays there.
+	TEST_CHECK(result.window.size == kMaxUploadPerSession);
+	TEST_CHECK(result.minWindow == kStartUploadPerSession);
+	TEST_CHECK(result.maxSent == kMaxUploadPerSession);
+}
+
+void TestSlowLink() {
+	const auto link = Link{ .bandwidth = 256 * 1024, .rtt = 300 };
+	const auto result = Simulate(link, kBigFilePartSize);
+
+	// Each part takes longer than a second, the window shrinks to the
+	// minimum and still one part at a time is sent, the link is idle
+	// only for a round trip after each part.
+	TEST_CHECK(result.window.size == kMinUploadPerSession);
+	TEST_CHECK(result.window.full(kBigFilePartSize, kBigFilePartSize));
+	TEST_CHECK(Throughput(result) > link.bandwidth * 8 / 10);
+}
+
+void TestMediumLink() {
+	const auto link = Link{ .bandwidth = 1024 * 1024, .rtt = 250 };
+	const auto result = Simulate(link, kBigFilePartSize);
+
+	// The window goes up and down around the link capacity
+	// and the link is kept busy.
+	TEST_CHECK(result.minWindow < kStartUploadPerSession);
+	TEST_CHECK(result.maxWindow >= kStartUploadPerSession);
+	TEST_CHECK(Throughput(result) > link.bandwidth * 8 / 10);
+}
+
+void TestSmallParts() {
+	const auto link = Link{ .bandwidth = 10 * 1024 * 1024, .rtt = 100 };
+	const auto result = Simulate(link, 32 * 1024);
+
+	TEST_CHECK(result.window.size == kMaxUploadPerSession);
+	TEST_CHECK(Throughput(result) > link.bandwidth * 8 / 10);
+}
+
+void TestHalveOncePerWindow() {
+	auto window = UploadSessionWindow();
+
+	// All the slow requests sent before the decrease halve it once.
+	window.requestDone(10, 1500, kBigFilePartSize, false);
+	TEST_CHECK(window.size == kStartUploadPerSession / 2);
+	window.requestDone(100, 1600, kBigFilePartSize, false);
+	window.requestDone(1500, 2700, kBigFilePartSize, false);
+	TEST_CHECK(window.size == kStartUploadPerSession / 2);
+
+	// A request sent after the decrease halves it again.
+	window.requestDone(1501, 2800, kBigFilePartSize, false);
+	TEST_CHECK(window.size == kMinUploadPerSession);
+	window.requestDone(3000, 4500, kBigFilePartSize, false);
+	TEST_CHECK(window.size == kMinUploadPerSession);
+}
+
+void TestFull() {
+	auto window = UploadSessionWindow();
+
+	// One part always fits, even if it is larger than the window.
+	window.size = kMinUploadPerSession;
+	TEST_CHECK(!window.full(0, kBigFilePartSize));
+	TEST_CHECK(window.full(kBigFilePartSize, kBigFilePartSize));
+	window.size = kStartUploadPerSession;
+	TEST_CHECK(!window.full(kBigFilePartSize, kBigFilePartSize));
+	TEST_CHECK(window.full(2 * kBigFilePartSize, 1));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	TestFastLink();
+	TestSlowLink();
+	TestMediumLink();
+	TestSmallParts();
+	TestHalveOncePerWindow();
+	TestFull();
+	return Test::ChecksResult("test_storage_upload_window");
+}
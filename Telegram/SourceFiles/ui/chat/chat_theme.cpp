@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/ui_utility.h"
 #include "ui/chat/message_bubble.h"
 #include "ui/chat/chat_style.h"
+#include "ui/chat/chat_theme_pixels.h"
 #include "ui/color_contrast.h"
 #include "ui/style/style_core_palette.h"
 #include "ui/style/style_palette_colorizer.h"
@@ -780,11 +781,14 @@ QColor CountAverageColor(const QImage &image) {
 	const auto h = image.height();
 	const auto size = w * h;
 	if (const auto pix = image.constBits()) {
-		for (auto i = 0, l = size * 4; i != l; i += 4) {
-			components[2] += pix[i + 0];
-			components[1] += pix[i + 1];
-			components[0] += pix[i + 2];
-		}
+		const auto sum = SumColorComponents(
+			pix,
+			w,
+			h,
+			image.bytesPerLine());
+		components[0] = sum.red;
+		components[1] = sum.green;
+		components[2] = sum.blue;
 	}
 	if (size) {
 		for (auto &component : components) {
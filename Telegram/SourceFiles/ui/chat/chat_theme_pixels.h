@@ -0,0 +1,45 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/basic_types.h"
+
+namespace Ui {
+
+struct ColorComponentsSum {
+	uint64 red = 0;
+	uint64 green = 0;
+	uint64 blue = 0;
+};
+
+// For 32 bit (A)RGB pixels, lines may be padded up to bytesPerLine.
+[[nodiscard]] inline ColorComponentsSum SumColorComponents(
+		const uchar *bits,
+		int width,
+		int height,
+		int bytesPerLine) {
+	auto result = ColorComponentsSum();
+	for (auto y = 0; y != height; ++y) {
+		// 32 bit sums are enough for a line and vectorize better.
+		uint32 line[3] = { 0 };
+		const auto ints = reinterpret_cast<const uint32*>(
+			bits + y * bytesPerLine);
+		for (auto x = 0; x != width; ++x) {
+			const auto color = ints[x];
+			line[0] += (color >> 16) & 0xFF;
+			line[1] += (color >> 8) & 0xFF;
+			line[2] += color & 0xFF;
+		}
+		result.red += line[0];
+		result.green += line[1];
+		result.blue += line[2];
+	}
+	return result;
+}
+
+} // namespace Ui
@@ -245,6 +245,7 @@ PRIVATE
     statistics/view/chart_rulers_view.h
     statistics/view/chart_view_factory.cpp
     statistics/view/chart_view_factory.h
+    statistics/view/linear_chart_decimation.h
     statistics/view/linear_chart_view.cpp
     statistics/view/linear_chart_view.h
     statistics/view/stack_chart_common.cpp
@@ -328,6 +329,7 @@ PRIVATE
     ui/chat/chat_style_radius.h
     ui/chat/chat_theme.cpp
     ui/chat/chat_theme.h
+    ui/chat/chat_theme_pixels.h
     ui/chat/continuous_scroll.cpp
     ui/chat/continuous_scroll.h
     ui/chat/forward_options_box.cpp
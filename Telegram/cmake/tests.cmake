@@ -42,3 +42,77 @@ set_target_properties(test_text PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINA
 add_dependencies(Telegram test_text)
 
 target_prepare_qrc(test_text)
+
+# Console tests for the logic that doesn't need the application.
+function(add_console_test target_name)
+    add_executable(${target_name})
+    init_target(${target_name} "(tests)")
+
+    target_include_directories(${target_name} PRIVATE ${src_loc})
+
+    nice_target_sources(${target_name} ${src_loc}
+    PRIVATE
+        tests/test_checks.h
+        ${ARGN}
+    )
+
+    target_link_libraries(${target_name}
+    PRIVATE
+        desktop-app::lib_base
+        desktop-app::lib_crl
+        desktop-app::external_qt
+    )
+
+    set_target_properties(${target_name} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR})
+
+    add_dependencies(Telegram ${target_name})
+endfunction()
+
+add_console_test(test_storage_download_balance
+    storage/details/storage_download_balance.cpp
+    storage/details/storage_download_balance.h
+    tests/test_storage_download_balance.cpp
+)
+
+add_console_test(test_storage_download_queue
+    storage/details/storage_download_queue.h
+    tests/test_storage_download_queue.cpp
+)
+
+add_console_test(test_storage_upload_window
+    storage/details/storage_upload_window.cpp
+    storage/details/storage_upload_window.h
+    tests/test_storage_upload_window.cpp
+)
+
+add_console_test(test_export_output_escape
+    export/output/export_output_escape.cpp
+    export/output/export_output_escape.h
+    tests/test_export_output_escape.cpp
+)
+
+add_console_test(test_dialogs_name_index
+    dialogs/dialogs_name_index.h
+    tests/test_dialogs_name_index.cpp
+)
+
+add_console_test(test_pixel_loops
+    ffmpeg/ffmpeg_premultiply.h
+    ui/chat/chat_theme_pixels.h
+    tests/test_pixel_loops.cpp
+)
+
+add_console_test(test_data_group_call_participants
+    data/data_group_call_participants.h
+    tests/test_data_group_call_participants.cpp
+)
+
+add_console_test(test_linear_chart_decimation
+    statistics/view/linear_chart_decimation.h
+    tests/test_linear_chart_decimation.cpp
+)
+
+add_console_test(test_history_view_deferred_resize
+    history/view/history_view_deferred_resize.h
+    tests/test_history_view_deferred_resize.cpp
+)